@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    BenchmarkHelpers.h
+
+    Shared pieces for the benchmarks: a timer that keeps the fastest of several
+    runs, test material that keeps the compressors working, the generic
+    juce::dsp chain the engine replaced, as the baseline to compare against,
+    and the crossover band the dynamic EQ band stands in for.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+struct BenchmarkHelpers
+{
+    // nanoseconds per sample frame of the fastest of numRuns runs, each processing numFrames
+    // frames; setUp is called before every run and isn't timed
+    template <typename SetUp, typename Run>
+    static double timePerFrame(juce::int64 numFrames, int numRuns, SetUp&& setUp, Run&& run)
+    {
+        auto best = std::numeric_limits<double>::max();
+
+        for (int i = 0; i < numRuns; ++i)
+        {
+            setUp();
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            run();
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            best = juce::jmin(best, seconds * 1.0e9 / static_cast<double>(numFrames));
+        }
+
+        return best;
+    }
+
+    // noise alternating between 0 and -30 dBFS every 50ms, so the envelopes attack and release throughout
+    static juce::AudioBuffer<float> createTestSignal(double sampleRate, int numChannels, double seconds)
+    {
+        juce::AudioBuffer<float> signal(numChannels, juce::roundToInt(seconds * sampleRate));
+        juce::Random random(0x5eed);
+        const auto stepLength = juce::jmax(1, juce::roundToInt(0.05 * sampleRate));
+
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+        {
+            const auto level = (i / stepLength) % 2 == 0 ? 1.0f : 0.0316f;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                signal.setSample(ch, i, level * (2.0f * random.nextFloat() - 1.0f));
+        }
+
+        return signal;
+    }
+
+    // settings that keep the compressor in gain reduction most of the time
+    static EngineParameters getWorkingParameters()
+    {
+        EngineParameters parameters;
+        parameters.threshold = -24.0f;
+        parameters.ratio = 4.0f;
+        parameters.attack = 1.0f;
+        parameters.release = 3.0f;
+        parameters.outputGain = 6.0f;
+        parameters.mixer = 50.0f;
+        return parameters;
+    }
+
+    // hands the buffer to process in blockSize chunks, in place
+    template <typename Process>
+    static void processInBlocks(juce::AudioBuffer<float>& buffer, int blockSize, Process&& process)
+    {
+        const auto numSamples = buffer.getNumSamples();
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                           start, juce::jmin(blockSize, numSamples - start));
+            process(block);
+        }
+    }
+
+    //==============================================================================
+    // the chain the engine replaced: juce::dsp gains, compressor and dry/wet mixer, a pass each
+    struct GenericChain
+    {
+        void prepare(double sampleRate, int maximumBlockSize, int numChannels, const EngineParameters& parameters)
+        {
+            const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(maximumBlockSize), static_cast<juce::uint32>(numChannels) };
+
+            inputGain.prepare(spec);
+            outputGain.prepare(spec);
+            compressor.prepare(spec);
+            mixer.prepare(spec);
+
+            inputGain.setRampDurationSeconds(ParallelCompressorEngine::gainRampSeconds);
+            outputGain.setRampDurationSeconds(ParallelCompressorEngine::gainRampSeconds);
+
+            inputGain.setGainDecibels(parameters.inputGain);
+            outputGain.setGainDecibels(parameters.outputGain);
+            compressor.setThreshold(parameters.threshold);
+            compressor.setRatio(parameters.ratio);
+            compressor.setAttack(ParallelCompressorEngine::calcAttack(parameters.attack));
+            compressor.setRelease(ParallelCompressorEngine::calcRelease(parameters.release));
+            mixer.setWetMixProportion(parameters.mixer / 100);
+
+            inputGain.reset();
+            outputGain.reset();
+            compressor.reset();
+            mixer.reset();
+        }
+
+        void process(juce::AudioBuffer<float>& buffer)
+        {
+            juce::dsp::AudioBlock<float> block(buffer);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+
+            mixer.pushDrySamples(block);
+            inputGain.process(context);
+            compressor.process(context);
+            outputGain.process(context);
+            mixer.mixWetSamples(block);
+        }
+
+        juce::dsp::Gain<float> inputGain, outputGain;
+        juce::dsp::Compressor<float> compressor;
+        juce::dsp::DryWetMixer<float> mixer;
+    };
+
+    //==============================================================================
+    // frequency-selective compression the crossover way: Linkwitz-Riley splits at the dynamic EQ
+    // band's edges, a juce::dsp compressor on the middle band and the three bands summed back
+    struct CrossoverBand
+    {
+        void prepare(double sampleRate, int maximumBlockSize, int numChannels, const EngineParameters& parameters)
+        {
+            const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(maximumBlockSize), static_cast<juce::uint32>(numChannels) };
+
+            lowSplit.prepare(spec);
+            highSplit.prepare(spec);
+            compressor.prepare(spec);
+
+            // the -3 dB points of a band-pass with the band's Q
+            const auto offset = 1.0f / (2.0f * parameters.dynamicEqQ);
+            const auto spread = std::sqrt(1.0f + offset * offset);
+            const auto nyquistLimit = static_cast<float>(sampleRate * 0.45);
+
+            lowSplit.setCutoffFrequency(juce::jmin(parameters.dynamicEqFrequency * (spread - offset), nyquistLimit));
+            highSplit.setCutoffFrequency(juce::jmin(parameters.dynamicEqFrequency * (spread + offset), nyquistLimit));
+            compressor.setThreshold(parameters.threshold);
+            compressor.setRatio(parameters.ratio);
+            compressor.setAttack(ParallelCompressorEngine::calcAttack(parameters.attack));
+            compressor.setRelease(ParallelCompressorEngine::calcRelease(parameters.release));
+
+            lowSplit.reset();
+            highSplit.reset();
+            compressor.reset();
+        }
+
+        void process(juce::AudioBuffer<float>& buffer)
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                auto* samples = buffer.getWritePointer(ch);
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                {
+                    float low, rest, band, high;
+                    lowSplit.processSample(ch, samples[i], low, rest);
+                    highSplit.processSample(ch, rest, band, high);
+                    samples[i] = low + compressor.processSample(ch, band) + high;
+                }
+            }
+        }
+
+        juce::dsp::LinkwitzRileyFilter<float> lowSplit, highSplit;
+        juce::dsp::Compressor<float> compressor;
+    };
+};
@@ -0,0 +1,287 @@
+/*
+  ==============================================================================
+
+    EngineBenchmarks.cpp
+
+    The specialised kernels against the generic juce::dsp chain, the kernels
+    against each other across stereo modes and quality tiers, the auto
+    release kernels against the fixed release ones, the dynamic EQ band
+    against a crossover band, automated parameters against static ones,
+    and a session's worth of instances taking turns the way a host calls
+    them.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkHelpers.h"
+#include "AutomationLanes.h"
+
+//==============================================================================
+class EngineBenchmarks : public juce::UnitTest
+{
+public:
+    EngineBenchmarks() : juce::UnitTest("Engine kernels", "Benchmarks") {}
+
+    void runTest() override
+    {
+        const auto parameters = BenchmarkHelpers::getWorkingParameters();
+
+        beginTest("Specialised kernels vs. generic chain");
+
+        for (auto numChannels : { 1, 2 })
+        {
+            const auto signal = BenchmarkHelpers::createTestSignal(sampleRate, numChannels, seconds);
+
+            for (auto blockSize : { 32, 512 })
+            {
+                BenchmarkHelpers::GenericChain chain;
+                const auto generic = timeRuns(signal, [&] { chain.prepare(sampleRate, blockSize, numChannels, parameters); },
+                                              blockSize, [&](juce::AudioBuffer<float>& block) { chain.process(block); });
+
+                ParallelCompressorEngine engine;
+                const auto specialised = timeRuns(signal, [&] { prepareEngine(engine, blockSize, numChannels, parameters); },
+                                                  blockSize, [&](juce::AudioBuffer<float>& block) { processEngine(engine, block); });
+
+                logMessage(juce::String(numChannels == 1 ? "mono" : "stereo") + ", " + juce::String(blockSize) + "-sample blocks: generic "
+                           + juce::String(generic, 2) + " ns, specialised " + juce::String(specialised, 2) + " ns per frame ("
+                           + juce::String(generic / specialised, 1) + "x)");
+
+                expect(specialised > 0.0 && std::isfinite(specialised));
+            }
+        }
+
+        beginTest("Stereo modes and quality tiers");
+
+        const auto signal = BenchmarkHelpers::createTestSignal(sampleRate, 2, seconds);
+        const char* modeNames[] = { "L/R", "M/S", "M only", "S only" };
+        const char* tierNames[] = { "high", "medium", "low" };
+
+        for (int mode = 0; mode < 4; ++mode)
+        {
+            auto modeParameters = parameters;
+            modeParameters.stereoMode = static_cast<StereoMode>(mode);
+
+            juce::String line = juce::String(modeNames[mode]) + ":";
+
+            for (int tier = 0; tier < numQualityTiers; ++tier)
+            {
+                ParallelCompressorEngine engine;
+                const auto nanoseconds = timeRuns(signal, [&] { prepareEngine(engine, 512, 2, modeParameters);
+                                                                engine.setQualityTier(static_cast<QualityTier>(tier)); },
+                                                  512, [&](juce::AudioBuffer<float>& block) { processEngine(engine, block); });
+
+                line << " " << tierNames[tier] << " " << juce::String(nanoseconds, 2) << " ns";
+            }
+
+            logMessage(line + " per frame");
+        }
+
+        beginTest("Auto release vs. fixed release");
+
+        for (int tier = 0; tier < numQualityTiers; ++tier)
+        {
+            double nanoseconds[2] = {};
+
+            for (int automatic = 0; automatic < 2; ++automatic)
+            {
+                auto releaseParameters = parameters;
+                releaseParameters.autoRelease = automatic == 1;
+
+                ParallelCompressorEngine engine;
+                nanoseconds[automatic] = timeRuns(signal, [&] { prepareEngine(engine, 512, 2, releaseParameters);
+                                                                engine.setQualityTier(static_cast<QualityTier>(tier)); },
+                                                  512, [&](juce::AudioBuffer<float>& block) { processEngine(engine, block); });
+            }
+
+            logMessage(juce::String(tierNames[tier]) + ": fixed " + juce::String(nanoseconds[0], 2) + " ns, auto "
+                       + juce::String(nanoseconds[1], 2) + " ns per frame (" + juce::String(nanoseconds[1] / nanoseconds[0], 2) + "x)");
+        }
+
+        beginTest("Dynamic EQ band vs. crossover band");
+
+        // what each way of compressing one band adds to the engine; the crossover band runs after the
+        // engine rather than in its wet path, which costs the same
+        for (auto blockSize : { 32, 512 })
+        {
+            double nanoseconds[2] = {};
+
+            for (int band = 0; band < 2; ++band)
+            {
+                auto bandParameters = parameters;
+                bandParameters.dynamicEq = band == 1;
+
+                ParallelCompressorEngine engine;
+                nanoseconds[band] = timeRuns(signal, [&] { prepareEngine(engine, blockSize, 2, bandParameters); },
+                                             blockSize, [&](juce::AudioBuffer<float>& block) { processEngine(engine, block); });
+            }
+
+            ParallelCompressorEngine engine;
+            BenchmarkHelpers::CrossoverBand crossover;
+            const auto crossed = timeRuns(signal, [&] { prepareEngine(engine, blockSize, 2, parameters);
+                                                        crossover.prepare(sampleRate, blockSize, 2, parameters); },
+                                          blockSize, [&](juce::AudioBuffer<float>& block) { processEngine(engine, block);
+                                                                                            crossover.process(block); });
+
+            const auto dynamicEqCost = nanoseconds[1] - nanoseconds[0];
+            const auto crossoverCost = crossed - nanoseconds[0];
+
+            logMessage(juce::String(blockSize) + "-sample blocks: engine " + juce::String(nanoseconds[0], 2) + " ns, dynamic EQ band +"
+                       + juce::String(dynamicEqCost, 2) + " ns, crossover band +" + juce::String(crossoverCost, 2) + " ns per frame"
+                       + (dynamicEqCost > 0.0 ? " (" + juce::String(crossoverCost / dynamicEqCost, 1) + "x)" : juce::String()));
+
+            expect(nanoseconds[1] > 0.0 && std::isfinite(nanoseconds[1]));
+        }
+
+        beginTest("Automated vs. static parameters");
+
+        // every parameter a lane is likely to carry, ramping for the whole signal, applied the way an
+        // offline render applies it: on the control-rate grid, with blocks split there
+        AutomationLanes lanes;
+        const auto parsed = lanes.parse(R"({
+                                               "input gain": [ [0.0, 0.0], [2.0, 6.0] ],
+                                               "threshold":  [ [0.0, -30.0], [2.0, -12.0] ],
+                                               "mixer":      [ [0.0, 100.0], [2.0, 30.0] ],
+                                               "side mixer": [ [0.0, 100.0], [2.0, 50.0] ]
+                                           })");
+        expect(parsed.wasOk(), parsed.getErrorMessage());
+        lanes.prepare(sampleRate);
+
+        for (auto blockSize : { 32, 512 })
+        {
+            auto automatedParameters = parameters;
+            automatedParameters.stereoMode = StereoMode::midSide;
+
+            ParallelCompressorEngine engine;
+            const auto fixed = timeRuns(signal, [&] { prepareEngine(engine, blockSize, 2, automatedParameters); },
+                                        blockSize, [&](juce::AudioBuffer<float>& block) { processEngine(engine, block); });
+
+            juce::int64 position = 0, nextEvent = 0;
+            const auto automated = timeRuns(signal, [&] { prepareEngine(engine, blockSize, 2, automatedParameters); position = nextEvent = 0; },
+                                            blockSize, [&](juce::AudioBuffer<float>& block)
+                                            { processAutomated(engine, lanes, block, position, nextEvent); });
+
+            logMessage(juce::String(blockSize) + "-sample blocks: static " + juce::String(fixed, 2) + " ns, automated "
+                       + juce::String(automated, 2) + " ns per frame (" + juce::String(automated / fixed, 2) + "x)");
+
+            expect(automated > 0.0 && std::isfinite(automated));
+        }
+
+        beginTest("Many instances vs. generic chains");
+
+        const auto sessionSignal = BenchmarkHelpers::createTestSignal(sampleRate, 2, sessionSeconds);
+
+        for (auto numInstances : { 16, 256 })
+        {
+            std::vector<std::unique_ptr<BenchmarkHelpers::GenericChain>> chains;
+            std::vector<std::unique_ptr<ParallelCompressorEngine>> engines;
+
+            for (int i = 0; i < numInstances; ++i)
+            {
+                chains.push_back(std::make_unique<BenchmarkHelpers::GenericChain>());
+                engines.push_back(std::make_unique<ParallelCompressorEngine>());
+            }
+
+            const auto generic = timeSession(sessionSignal, chains,
+                                             [&](BenchmarkHelpers::GenericChain& chain) { chain.prepare(sampleRate, sessionBlockSize, 2, parameters); },
+                                             [](BenchmarkHelpers::GenericChain& chain, juce::AudioBuffer<float>& block) { chain.process(block); });
+
+            const auto specialised = timeSession(sessionSignal, engines,
+                                                 [&](ParallelCompressorEngine& engine) { prepareEngine(engine, sessionBlockSize, 2, parameters); },
+                                                 [](ParallelCompressorEngine& engine, juce::AudioBuffer<float>& block) { processEngine(engine, block); });
+
+            logMessage(juce::String(numInstances) + " stereo instances, " + juce::String(sessionBlockSize) + "-sample blocks: generic "
+                       + juce::String(generic, 2) + " ns, specialised " + juce::String(specialised, 2) + " ns per frame per instance ("
+                       + juce::String(generic / specialised, 1) + "x), " + juce::String(engines.front()->getMemoryFootprintBytes())
+                       + " bytes per engine");
+
+            expect(specialised > 0.0 && std::isfinite(specialised));
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr double seconds = 2.0;
+    static constexpr int numRuns = 5;
+
+    // every instance in a session is fed from one short signal, so only the instances' own state competes for the cache
+    static constexpr double sessionSeconds = 0.5;
+    static constexpr int sessionBlockSize = 128;
+
+    // best-of-numRuns ns per frame of processing a fresh copy of the signal in blockSize chunks
+    template <typename SetUp, typename Process>
+    static double timeRuns(const juce::AudioBuffer<float>& signal, SetUp&& setUp, int blockSize, Process&& process)
+    {
+        juce::AudioBuffer<float> work;
+
+        return BenchmarkHelpers::timePerFrame(signal.getNumSamples(), numRuns,
+                                              [&] { work.makeCopyOf(signal); setUp(); },
+                                              [&] { BenchmarkHelpers::processInBlocks(work, blockSize, process); });
+    }
+
+    // best-of-numRuns ns per frame per instance of every instance processing a fresh copy of each block
+    // in turn, as a host calls one track after another, so each instance's state has gone cold in between
+    template <typename Instance, typename Prepare, typename Process>
+    static double timeSession(const juce::AudioBuffer<float>& signal, std::vector<std::unique_ptr<Instance>>& instances,
+                              Prepare&& prepare, Process&& process)
+    {
+        juce::AudioBuffer<float> block(signal.getNumChannels(), sessionBlockSize);
+        const auto numBlocks = signal.getNumSamples() / sessionBlockSize;
+        const auto numFrames = static_cast<juce::int64>(numBlocks * sessionBlockSize) * static_cast<juce::int64>(instances.size());
+
+        return BenchmarkHelpers::timePerFrame(numFrames, numRuns,
+                                              [&] { for (auto& instance : instances) prepare(*instance); },
+                                              [&]
+                                              {
+                                                  for (int start = 0; start < numBlocks * sessionBlockSize; start += sessionBlockSize)
+                                                  {
+                                                      for (auto& instance : instances)
+                                                      {
+                                                          for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                                                              block.copyFrom(ch, 0, signal, ch, start, sessionBlockSize);
+
+                                                          process(*instance, block);
+                                                      }
+                                                  }
+                                              });
+    }
+
+    static void prepareEngine(ParallelCompressorEngine& engine, int blockSize, int numChannels, const EngineParameters& parameters)
+    {
+        engine.setParameters(parameters);
+        engine.prepare(sampleRate, blockSize, numChannels);
+    }
+
+    static void processEngine(ParallelCompressorEngine& engine, juce::AudioBuffer<float>& block)
+    {
+        engine.process(block.getArrayOfWritePointers(), block.getNumChannels(), block.getNumSamples());
+    }
+
+    // as processEngine(), applying the lanes at their events (see OfflineRenderer::processRange())
+    static void processAutomated(ParallelCompressorEngine& engine, const AutomationLanes& lanes, juce::AudioBuffer<float>& block,
+                                 juce::int64& position, juce::int64& nextEvent)
+    {
+        auto parameters = engine.getParameters();
+        float* channels[ParallelCompressorEngine::maxChannels] = {};
+
+        for (int offset = 0; offset < block.getNumSamples();)
+        {
+            if (position == nextEvent)
+            {
+                lanes.apply(position, parameters);
+                engine.setParameters(parameters);
+                nextEvent = lanes.getNextEvent(position);
+            }
+
+            const auto numSamples = static_cast<int>(juce::jmin<juce::int64>(block.getNumSamples() - offset, nextEvent - position));
+
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                channels[ch] = block.getWritePointer(ch, offset);
+
+            engine.process(channels, block.getNumChannels(), numSamples);
+            offset += numSamples;
+            position += numSamples;
+        }
+    }
+};
+
+static EngineBenchmarks engineBenchmarks;
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Runs the benchmarks (juce::UnitTests in the "Benchmarks" category). Pass
+    part of a benchmark's name to run only the matching ones.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::Array<juce::UnitTest*> benchmarks;
+
+    for (auto* test : juce::UnitTest::getTestsInCategory("Benchmarks"))
+        if (argc < 2 || test->getName().containsIgnoreCase(argv[1]))
+            benchmarks.add(test);
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTests(benchmarks);
+
+    auto failures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Runs the render daemon until SIGINT or SIGTERM:
+
+        ParallelCompressionDaemon [--socket <path>] [--workers <n>] [--queue <n>]
+                                  [--block-size <n>] [--timeout <seconds>]
+
+    or, as a client, sends it one request and prints the reply:
+
+        ParallelCompressionDaemon [--socket <path>] send stats
+        ParallelCompressionDaemon [--socket <path>] send render in.wav out.wav threshold=-24
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RenderDaemon.h"
+
+#include <csignal>
+#include <iostream>
+#include <pthread.h>
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    RenderDaemon::Options options;
+    juce::StringArray request;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String argument(argv[i]);
+        const auto hasValue = i + 1 < argc;
+
+        if (argument == "send")
+        {
+            for (++i; i < argc; ++i)
+                request.add(argv[i]);
+        }
+        else if (argument == "--socket" && hasValue)      options.socketPath = argv[++i];
+        else if (argument == "--workers" && hasValue)     options.numWorkers = juce::String(argv[++i]).getIntValue();
+        else if (argument == "--queue" && hasValue)       options.maxQueuedJobs = juce::String(argv[++i]).getIntValue();
+        else if (argument == "--block-size" && hasValue)  options.blockSize = juce::String(argv[++i]).getIntValue();
+        else if (argument == "--timeout" && hasValue)     options.requestTimeoutSeconds = juce::String(argv[++i]).getIntValue();
+        else
+        {
+            std::cerr << "Unknown argument " << argument << std::endl;
+            return 2;
+        }
+    }
+
+    if (! request.isEmpty())
+    {
+        const auto reply = RenderDaemon::sendRequest(options.socketPath, request.joinIntoString("\t"));
+        std::cout << reply << std::endl;
+        return reply.startsWith("error") ? 1 : 0;
+    }
+
+    // the workers inherit this mask, so the signals only ever reach sigwait() below
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    RenderDaemon daemon(options);
+    const auto result = daemon.start();
+
+    if (result.failed())
+    {
+        std::cerr << result.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Listening on " << options.socketPath << std::endl;
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+
+    daemon.stop();
+    return 0;
+}
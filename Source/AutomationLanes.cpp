@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    AutomationLanes.cpp
+
+  ==============================================================================
+*/
+
+#include "AutomationLanes.h"
+
+//==============================================================================
+juce::Result AutomationLanes::loadFromFile(const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail("Couldn't find " + file.getFullPathName());
+
+    return parse(file.loadFileAsString());
+}
+
+juce::Result AutomationLanes::parse(const juce::String& json)
+{
+    juce::var root;
+    const auto result = juce::JSON::parse(json, root);
+
+    if (result.failed())
+        return result;
+
+    auto* object = root.getDynamicObject();
+
+    if (object == nullptr)
+        return juce::Result::fail("Automation must be an object of parameter lanes");
+
+    std::vector<Lane> newLanes;
+
+    for (auto& property : object->getProperties())
+    {
+        Lane lane;
+        lane.parameterID = property.name.toString();
+
+        if (! EngineParameters::getParameterIDs().contains(lane.parameterID))
+            return juce::Result::fail("Unknown parameter " + lane.parameterID);
+
+        auto* points = property.value.getArray();
+
+        if (points == nullptr || points->isEmpty())
+            return juce::Result::fail("Lane " + lane.parameterID + " has no breakpoints");
+
+        for (auto& point : *points)
+        {
+            if (! point.isArray() || point.size() != 2)
+                return juce::Result::fail("Breakpoints in " + lane.parameterID + " must be [seconds, value]");
+
+            Breakpoint breakpoint;
+            breakpoint.time = static_cast<double>(point[0]);
+            breakpoint.value = static_cast<float>(static_cast<double>(point[1]));
+            lane.points.push_back(breakpoint);
+        }
+
+        // stable, so equal times keep their file order and form a step
+        std::stable_sort(lane.points.begin(), lane.points.end(),
+                         [](const Breakpoint& a, const Breakpoint& b) { return a.time < b.time; });
+
+        newLanes.push_back(std::move(lane));
+    }
+
+    lanes = std::move(newLanes);
+    return juce::Result::ok();
+}
+
+void AutomationLanes::prepare(double sampleRate)
+{
+    for (auto& lane : lanes)
+        for (auto& point : lane.points)
+            point.sample = static_cast<juce::int64>(std::llround(point.time * sampleRate));
+}
+
+//==============================================================================
+int AutomationLanes::Lane::findSegment(juce::int64 position) const
+{
+    const auto next = std::upper_bound(points.begin(), points.end(), position,
+                                       [](juce::int64 p, const Breakpoint& b) { return p < b.sample; });
+    return static_cast<int>(next - points.begin()) - 1;
+}
+
+juce::int64 AutomationLanes::getNextBreakpoint(juce::int64 position) const
+{
+    auto next = std::numeric_limits<juce::int64>::max();
+
+    for (auto& lane : lanes)
+    {
+        const auto index = lane.findSegment(position) + 1;
+
+        if (index < static_cast<int>(lane.points.size()))
+            next = juce::jmin(next, lane.points[(size_t) index].sample);
+    }
+
+    return next;
+}
+
+bool AutomationLanes::isRamping(juce::int64 position) const
+{
+    for (auto& lane : lanes)
+    {
+        const auto index = lane.findSegment(position);
+
+        if (index >= 0 && index + 1 < static_cast<int>(lane.points.size())
+            && ! juce::exactlyEqual(lane.points[(size_t) index].value, lane.points[(size_t) index + 1].value))
+            return true;
+    }
+
+    return false;
+}
+
+juce::int64 AutomationLanes::getNextEvent(juce::int64 position) const
+{
+    auto next = getNextBreakpoint(position);
+
+    if (isRamping(position))
+        next = juce::jmin(next, (position / controlInterval + 1) * controlInterval);
+
+    return next;
+}
+
+void AutomationLanes::apply(juce::int64 position, EngineParameters& parameters) const
+{
+    for (auto& lane : lanes)
+    {
+        const auto index = lane.findSegment(position);
+        float value;
+
+        if (index < 0)
+        {
+            value = lane.points.front().value;
+        }
+        else if (index + 1 >= static_cast<int>(lane.points.size()))
+        {
+            value = lane.points.back().value;
+        }
+        else
+        {
+            const auto& from = lane.points[(size_t) index];
+            const auto& to = lane.points[(size_t) index + 1];
+            const auto proportion = static_cast<float>(position - from.sample) / static_cast<float>(to.sample - from.sample);
+            value = from.value + proportion * (to.value - from.value);
+        }
+
+        parameters.set(lane.parameterID, value);
+    }
+}
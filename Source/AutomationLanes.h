@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    AutomationLanes.h
+
+    Parameter automation for offline renders. The file is JSON with one lane of
+    [seconds, value] breakpoints per plugin parameter ID, e.g.
+
+        {
+            "threshold": [ [0.0, -12.0], [30.0, -12.0], [32.0, -24.0] ],
+            "mixer":     [ [0.0, 100.0], [45.5, 100.0], [45.5, 40.0] ]
+        }
+
+    Values ramp linearly between breakpoints; two breakpoints at the same time
+    make a step. Before the first and after the last breakpoint a lane holds
+    its value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+class AutomationLanes
+{
+public:
+    // while a lane is ramping, parameters are re-evaluated this often (in samples)
+    static constexpr int controlInterval = 32;
+
+    juce::Result loadFromFile(const juce::File& file);
+    juce::Result parse(const juce::String& json);
+
+    bool isEmpty() const { return lanes.empty(); }
+
+    // converts the breakpoint times to sample positions
+    void prepare(double sampleRate);
+
+    // first breakpoint after position, so a render can split its block there
+    juce::int64 getNextBreakpoint(juce::int64 position) const;
+
+    // true if any lane is between two breakpoints with different values
+    bool isRamping(juce::int64 position) const;
+
+    // first position after this one where the automated values change course: a breakpoint, or the
+    // next step of the control-rate grid while ramping. Renders apply the automation at these
+    // positions only, so where they split their blocks doesn't change the result
+    juce::int64 getNextEvent(juce::int64 position) const;
+
+    // writes every automated parameter's value at position into parameters
+    void apply(juce::int64 position, EngineParameters& parameters) const;
+
+private:
+    struct Breakpoint
+    {
+        double time = 0.0;
+        float value = 0.0f;
+        juce::int64 sample = 0;
+    };
+
+    struct Lane
+    {
+        juce::String parameterID;
+        std::vector<Breakpoint> points;
+
+        // index of the last breakpoint at or before position, or -1
+        int findSegment(juce::int64 position) const;
+    };
+
+    std::vector<Lane> lanes;
+};
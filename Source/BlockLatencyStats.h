@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    BlockLatencyStats.h
+
+    Running p99 / max of processBlock execution time. The audio thread bumps
+    one bucket of a log-spaced histogram per block (atomic, no locks); any
+    other thread can read a summary at any time, e.g. while a host or a
+    stress run is hammering the processor from several threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class BlockLatencyStats
+{
+public:
+    struct Summary
+    {
+        juce::int64 numBlocks = 0;
+        double p99Microseconds = 0.0;   // upper edge of the bucket holding the 99th percentile
+        double maxMicroseconds = 0.0;
+    };
+
+    void reset() noexcept
+    {
+        for (auto& bucket : buckets)
+            bucket = 0;
+
+        maxNanoseconds = 0;
+    }
+
+    // audio thread
+    void record(double seconds) noexcept
+    {
+        const auto microseconds = juce::jmax(1.0, seconds * 1.0e6);
+        const auto bucket = juce::jlimit(0, numBuckets - 1, static_cast<int>(std::log2(microseconds) * bucketsPerOctave));
+        buckets[(size_t) bucket].fetch_add(1, std::memory_order_relaxed);
+
+        const auto nanoseconds = static_cast<juce::int64>(seconds * 1.0e9);
+        auto previous = maxNanoseconds.load(std::memory_order_relaxed);
+
+        while (nanoseconds > previous && ! maxNanoseconds.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // any thread
+    Summary getSummary() const noexcept
+    {
+        std::array<juce::int64, numBuckets> counts;
+        Summary summary;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] = buckets[i].load(std::memory_order_relaxed);
+            summary.numBlocks += counts[i];
+        }
+
+        const auto target = summary.numBlocks - summary.numBlocks / 100;
+        juce::int64 seen = 0;
+
+        for (size_t i = 0; i < counts.size() && summary.numBlocks > 0; ++i)
+        {
+            seen += counts[i];
+
+            if (seen >= target)
+            {
+                summary.p99Microseconds = std::exp2((static_cast<double>(i) + 1.0) / bucketsPerOctave);
+                break;
+            }
+        }
+
+        summary.maxMicroseconds = static_cast<double>(maxNanoseconds.load(std::memory_order_relaxed)) / 1000.0;
+        return summary;
+    }
+
+private:
+    // 1us to ~65ms in quarter-octave steps (about 19% resolution)
+    static constexpr int bucketsPerOctave = 4;
+    static constexpr int numBuckets = 16 * bucketsPerOctave;
+
+    std::array<std::atomic<juce::int64>, numBuckets> buckets {};
+    std::atomic<juce::int64> maxNanoseconds { 0 };
+};
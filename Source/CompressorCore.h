@@ -0,0 +1,324 @@
+/*
+  ==============================================================================
+
+    CompressorCore.h
+
+    Peak compressor with the same ballistics and gain curve as
+    juce::dsp::Compressor, but inline so the processing kernels can unroll it.
+    Optionally the release is program dependent (auto release); like the
+    other kernel options that's a template argument of the processing calls,
+    so the fixed-release kernels don't carry it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class CompressorCore
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        update();
+        reset();
+    }
+
+    void reset()
+    {
+        envelope.fill(0.0f);
+        fastEnvelope.fill(0.0f);
+        slowEnvelope.fill(0.0f);
+        meanSquare.fill(0.0f);
+        peakHold.fill(0.0f);
+        crestWeight.fill(0.0f);
+        controlGain.fill(1.0f);
+        controlStep.fill(0.0f);
+        finishLinkedRamp();
+    }
+
+    void setThreshold(float newThresholdDb)
+    {
+        if (! juce::exactlyEqual(thresholdDb, newThresholdDb)) { thresholdDb = newThresholdDb; update(); }
+    }
+
+    void setRatio(float newRatio)
+    {
+        jassert(newRatio >= 1.0f);
+        if (! juce::exactlyEqual(ratio, newRatio)) { ratio = newRatio; update(); }
+    }
+
+    void setAttack(float newAttackMs)
+    {
+        if (! juce::exactlyEqual(attackMs, newAttackMs)) { attackMs = newAttackMs; update(); }
+    }
+
+    void setRelease(float newReleaseMs)
+    {
+        if (! juce::exactlyEqual(releaseMs, newReleaseMs)) { releaseMs = newReleaseMs; update(); }
+    }
+
+    // auto release: a fast and a slow release stage blended by the signal's crest factor, so
+    // spiky material recovers quickly and dense material slowly instead of pumping; the
+    // processing calls must then be the AutoRelease = true instantiations
+    void setAutoRelease(bool shouldUseAutoRelease)
+    {
+        if (shouldUseAutoRelease == autoRelease)
+            return;
+
+        autoRelease = shouldUseAutoRelease;
+
+        if (autoRelease)
+            startAutoReleaseFromEnvelope();
+    }
+
+    // peak envelope follower followed by the static curve, per channel
+    template <bool AutoRelease>
+    inline float processSample(int channel, float input) noexcept
+    {
+        return processGain<AutoRelease>(channel, input) * input;
+    }
+
+    // the gain alone, for detecting on one signal (e.g. a band-passed key) and applying it to another
+    template <bool AutoRelease>
+    inline float processGain(int channel, float key) noexcept
+    {
+        const auto gain = calcGain(juce::jmax(processEnvelope<AutoRelease>(channel, key), linkedLevel));
+
+        // kept so a switch to the control-rate path carries on from this gain
+        controlGain[(size_t) channel] = gain;
+        return gain;
+    }
+
+    // same ballistics, but the static curve is only evaluated at the start of each
+    // control interval and the gain ramps linearly across it
+    void startControlInterval(int channel, int interval) noexcept
+    {
+        const auto target = calcGain(juce::jmax(envelope[(size_t) channel], linkedLevel));
+        controlStep[(size_t) channel] = (target - controlGain[(size_t) channel]) / static_cast<float>(interval);
+    }
+
+    template <bool AutoRelease>
+    inline float processSampleControlRate(int channel, float input) noexcept
+    {
+        return processGainControlRate<AutoRelease>(channel, input) * input;
+    }
+
+    template <bool AutoRelease>
+    inline float processGainControlRate(int channel, float key) noexcept
+    {
+        processEnvelope<AutoRelease>(channel, key);
+
+        auto& gain = controlGain[(size_t) channel];
+        gain += controlStep[(size_t) channel];
+        return gain;
+    }
+
+    // level from other linked instances; the gain computer uses whichever is louder. It ramps
+    // there linearly over the next rampSamples sample frames (see stepLinkedLevel()), so a level
+    // that changes once per block doesn't step the gain at block boundaries
+    void setLinkedLevel(float newLevel, int rampSamples = 0) noexcept
+    {
+        linkedTarget = newLevel;
+        linkedRemaining = juce::jmax(0, rampSamples);
+
+        if (linkedRemaining > 0)
+            linkedStep = (linkedTarget - linkedLevel) / static_cast<float>(linkedRemaining);
+        else
+            finishLinkedRamp();
+    }
+
+    // sample frames left in the linked level's ramp
+    int getLinkedRampRemaining() const noexcept { return linkedRemaining; }
+
+    // once per sample frame, before the frame's gains; unconditional, so the caller stops calling
+    // it (or the ramp has finished and the step is 0) once getLinkedRampRemaining() frames are done
+    inline void stepLinkedLevel() noexcept { linkedLevel += linkedStep; }
+
+    // accounts for numSamples frames of stepping, landing exactly on the target at the ramp's end
+    void advanceLinkedRamp(int numSamples) noexcept
+    {
+        linkedRemaining -= numSamples;
+
+        if (linkedRemaining <= 0)
+            finishLinkedRamp();
+    }
+
+    // loudest envelope across channels, for publishing to linked instances
+    float getDetectorLevel(int numChannels) const noexcept
+    {
+        auto level = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            level = juce::jmax(level, envelope[(size_t) ch]);
+
+        return level;
+    }
+
+    // takes over another core's envelopes and gain ramp, keeping this core's settings
+    void copyRunningState(const CompressorCore& other) noexcept
+    {
+        envelope = other.envelope;
+        fastEnvelope = other.fastEnvelope;
+        slowEnvelope = other.slowEnvelope;
+        meanSquare = other.meanSquare;
+        peakHold = other.peakHold;
+        crestWeight = other.crestWeight;
+        controlGain = other.controlGain;
+        controlStep = other.controlStep;
+        linkedLevel = other.linkedLevel;
+        linkedTarget = other.linkedTarget;
+        linkedStep = other.linkedStep;
+        linkedRemaining = other.linkedRemaining;
+
+        if (autoRelease && ! other.autoRelease)
+            startAutoReleaseFromEnvelope();
+    }
+
+    // a one-pole coefficient c such that two states converge at least as fast as c^n after n samples
+    float getSlowestCoefficient() const noexcept
+    {
+        if (! autoRelease)
+            return juce::jmax(cteAttack, cteRelease);
+
+        // auto release is a cascade: the stages, the peak hold and the mean square converge at the
+        // slowest of their coefficients c, and the blend weight is smoothed from them, i.e. it lags
+        // behind through a second one-pole (no slower than c). Two cascaded one-poles at c differ by at
+        // most (n + 1) c^n, which is below sqrt(c)^n for any n long enough to get within a usable
+        // tolerance, so sqrt(c) (twice the settling time) bounds both. The weight's step targets can
+        // still differ while the two states straddle a step, but only while the material's crest
+        // factor sits right on it
+        const auto stages = juce::jmax(cteAttack, cteSlowRelease, cteCrest);
+        return std::sqrt(juce::jmax(stages, cteWeight));
+    }
+
+private:
+    template <bool AutoRelease>
+    inline float processEnvelope(int channel, float input) noexcept
+    {
+        const auto level = std::abs(input);
+        auto& state = envelope[(size_t) channel];
+
+        if constexpr (AutoRelease)
+        {
+            state = processAutoRelease(channel, level);
+        }
+        else
+        {
+            const auto cte = level > state ? cteAttack : cteRelease;
+            state = level + cte * (state - level);
+        }
+
+        return state;
+    }
+
+    // both stages pick up from the current envelope, with a crest factor of 1 (i.e. on the slow stage)
+    void startAutoReleaseFromEnvelope() noexcept
+    {
+        for (size_t ch = 0; ch < envelope.size(); ++ch)
+        {
+            fastEnvelope[ch] = slowEnvelope[ch] = envelope[ch];
+            meanSquare[ch] = envelope[ch] * envelope[ch];
+            peakHold[ch] = envelope[ch];
+            crestWeight[ch] = 0.0f;
+        }
+    }
+
+    void finishLinkedRamp() noexcept
+    {
+        linkedLevel = linkedTarget;
+        linkedStep = 0.0f;
+        linkedRemaining = 0;
+    }
+
+    // selects, multiplies and compares, no divide and no branches: both stages share the attack,
+    // an instant-attack peak hold against the mean square gives the crest factor, and that picks the blend
+    inline float processAutoRelease(int channel, float level) noexcept
+    {
+        auto& fast = fastEnvelope[(size_t) channel];
+        auto& slow = slowEnvelope[(size_t) channel];
+        auto& power = meanSquare[(size_t) channel];
+        auto& hold = peakHold[(size_t) channel];
+        auto& weight = crestWeight[(size_t) channel];
+
+        fast = level + (level > fast ? cteAttack : cteFastRelease) * (fast - level);
+        slow = level + (level > slow ? cteAttack : cteSlowRelease) * (slow - level);
+
+        const auto square = level * level;
+        power = square + cteCrest * (power - square);
+        hold = juce::jmax(level, hold * cteSlowRelease);
+
+        // crest factor squared (held peak^2 / mean square) against evenly spaced steps from 6 dB
+        // (slow stage) to 18 dB (fast stage), compared as peak^2 > step * mean square; the weight
+        // glides between steps so they don't click
+        const auto peakSquared = hold * hold;
+        auto target = 0.0f;
+
+        for (auto step : crestSquaredSteps)
+            target += peakSquared > step * power ? 1.0f / numCrestSteps : 0.0f;
+
+        weight = target + cteWeight * (weight - target);
+        return slow + weight * (fast - slow);
+    }
+
+    inline float calcGain(float env) const noexcept
+    {
+        return env < threshold ? 1.0f
+                               : std::pow(env * thresholdInverse, ratioInverse - 1.0f);
+    }
+
+    void update()
+    {
+        threshold = juce::Decibels::decibelsToGain(thresholdDb, -200.0f);
+        thresholdInverse = 1.0f / threshold;
+        ratioInverse = 1.0f / ratio;
+
+        cteAttack = calcCoefficient(attackMs);
+        cteRelease = calcCoefficient(releaseMs);
+
+        // auto release stages around the release setting, crest factor over ~200ms
+        cteFastRelease = calcCoefficient(releaseMs * 0.5f);
+        cteSlowRelease = calcCoefficient(releaseMs * 5.0f);
+        cteCrest = calcCoefficient(200.0f);
+        cteWeight = calcCoefficient(10.0f);
+    }
+
+    // one-pole coefficient for a time in ms, matching juce::dsp::BallisticsFilter
+    float calcCoefficient(float timeMs) const
+    {
+        if (timeMs < 1.0e-3f)
+            return 0.0f;
+
+        const auto expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate;
+        return static_cast<float>(std::exp(expFactor / timeMs));
+    }
+
+    // per-sample state and coefficients
+    std::array<float, maxChannels> envelope {};
+    std::array<float, maxChannels> controlGain {}, controlStep {};
+    float threshold = 1.0f, thresholdInverse = 1.0f, ratioInverse = 1.0f;
+    float cteAttack = 0.0f, cteRelease = 0.0f;
+    float linkedLevel = 0.0f, linkedStep = 0.0f;
+    bool autoRelease = false;
+
+    // auto release state and coefficients
+    std::array<float, maxChannels> fastEnvelope {}, slowEnvelope {}, meanSquare {}, peakHold {}, crestWeight {};
+    float cteFastRelease = 0.0f, cteSlowRelease = 0.0f, cteCrest = 0.0f, cteWeight = 0.0f;
+
+    // step midpoints evenly spaced in crest factor squared between 6 dB (3.98) and 18 dB (63.1)
+    static constexpr int numCrestSteps = 4;
+    static constexpr float crestSquaredSteps[numCrestSteps] = { 11.37f, 26.15f, 40.93f, 55.71f };
+
+    // linked level ramp, touched once per block
+    float linkedTarget = 0.0f;
+    int linkedRemaining = 0;
+
+    // parameters
+    double sampleRate = 44100.0;
+    float thresholdDb = 0.0f, ratio = 1.0f, attackMs = 1.0f, releaseMs = 100.0f;
+};
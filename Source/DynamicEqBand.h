@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    DynamicEqBand.h
+
+    Frequency-selective compression for the wet path. One state variable
+    filter per channel provides both the band-passed key for the detector and
+    the band that gets cut: y = x + (G - 1) * band, which is a peaking filter
+    whose depth G follows the detector. G is a per-sample multiply, so the
+    filter coefficients only change with the frequency and Q parameters.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CompressorCore.h"
+
+//==============================================================================
+class DynamicEqBand
+{
+public:
+    static constexpr int maxChannels = CompressorCore::maxChannels;
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        detector.prepare(sampleRate);
+        update();
+        reset();
+    }
+
+    void reset()
+    {
+        ic1eq.fill(0.0f);
+        ic2eq.fill(0.0f);
+        detector.reset();
+    }
+
+    void setFrequency(float newFrequencyHz)
+    {
+        if (! juce::exactlyEqual(frequencyHz, newFrequencyHz)) { frequencyHz = newFrequencyHz; update(); }
+    }
+
+    void setQ(float newQ)
+    {
+        jassert(newQ > 0.0f);
+        if (! juce::exactlyEqual(q, newQ)) { q = newQ; update(); }
+    }
+
+    // deepest cut the band can reach, in dB (<= 0)
+    void setRange(float newRangeDb)
+    {
+        rangeGain = juce::Decibels::decibelsToGain(juce::jmin(0.0f, newRangeDb));
+    }
+
+    // detector settings, same units as CompressorCore
+    void setThreshold(float newThresholdDb) { detector.setThreshold(newThresholdDb); }
+    void setRatio(float newRatio)           { detector.setRatio(newRatio); }
+    void setAttack(float newAttackMs)       { detector.setAttack(newAttackMs); }
+    void setRelease(float newReleaseMs)     { detector.setRelease(newReleaseMs); }
+    void setAutoRelease(bool shouldUseAutoRelease) { detector.setAutoRelease(shouldUseAutoRelease); }
+
+    // the detector's gain computer follows the engine's quality tier like the main compressor
+    void startControlInterval(int channel, int interval) noexcept { detector.startControlInterval(channel, interval); }
+
+    template <int GainInterval, bool AutoRelease>
+    inline float processSample(int channel, float input) noexcept
+    {
+        const auto band = processFilter(channel, input);
+
+        float gain;
+
+        if constexpr (GainInterval == 1)
+            gain = detector.processGain<AutoRelease>(channel, band);
+        else
+            gain = detector.processGainControlRate<AutoRelease>(channel, band);
+
+        return input + (juce::jmax(gain, rangeGain) - 1.0f) * band;
+    }
+
+    // takes over another band's filter and detector state, keeping this band's settings
+    void copyRunningState(const DynamicEqBand& other) noexcept
+    {
+        ic1eq = other.ic1eq;
+        ic2eq = other.ic2eq;
+        detector.copyRunningState(other.detector);
+    }
+
+    // how fast two states converge per sample: the slower of the envelope and the filter's pole radius
+    float getSlowestCoefficient() const noexcept
+    {
+        return juce::jmax(detector.getSlowestCoefficient(), poleRadius);
+    }
+
+private:
+    // trapezoidal (TPT) SVF, bandpass scaled to unity gain at the centre frequency
+    inline float processFilter(int channel, float input) noexcept
+    {
+        auto& s1 = ic1eq[(size_t) channel];
+        auto& s2 = ic2eq[(size_t) channel];
+
+        const auto v3 = input - s2;
+        const auto v1 = a1 * s1 + a2 * v3;
+        const auto v2 = s2 + a2 * s1 + a3 * v3;
+
+        s1 = 2.0f * v1 - s1;
+        s2 = 2.0f * v2 - s2;
+
+        return k * v1;
+    }
+
+    void update()
+    {
+        const auto cutoff = juce::jmin(static_cast<double>(frequencyHz), sampleRate * 0.45);
+        const auto g = std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+        const auto damping = 1.0 / q;
+
+        a1 = static_cast<float>(1.0 / (1.0 + g * (g + damping)));
+        a2 = static_cast<float>(g) * a1;
+        a3 = static_cast<float>(g) * a2;
+        k = static_cast<float>(damping);
+
+        // a resonator's poles sit at radius exp(-pi * bandwidth / sampleRate)
+        poleRadius = static_cast<float>(std::exp(-juce::MathConstants<double>::pi * cutoff / (q * sampleRate)));
+    }
+
+    // per-sample state and coefficients
+    std::array<float, maxChannels> ic1eq {}, ic2eq {};
+    float a1 = 0.0f, a2 = 0.0f, a3 = 0.0f, k = 1.0f;
+    float rangeGain = 1.0f;
+    CompressorCore detector;
+
+    // parameters
+    double sampleRate = 44100.0;
+    float frequencyHz = 3500.0f, q = 2.0f;
+    float poleRadius = 0.0f;
+};
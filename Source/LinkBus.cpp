@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    LinkBus.cpp
+
+  ==============================================================================
+*/
+
+#include "LinkBus.h"
+
+//==============================================================================
+LinkBus& LinkBus::getInstance()
+{
+    static LinkBus bus;
+    return bus;
+}
+
+int LinkBus::join(int group) noexcept
+{
+    if (group < 1 || group > numGroups)
+        return -1;
+
+    for (int i = 0; i < slotsPerGroup; ++i)
+    {
+        auto& slot = slots[group - 1][i];
+        bool expected = false;
+
+        if (slot.used.compare_exchange_strong(expected, true))
+        {
+            slot.level = 0.0f;
+            slot.epochMs = 0;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void LinkBus::leave(int group, int slot) noexcept
+{
+    if (group < 1 || group > numGroups || ! juce::isPositiveAndBelow(slot, slotsPerGroup))
+        return;
+
+    auto& s = slots[group - 1][slot];
+    s.level = 0.0f;
+    s.used = false;
+}
+
+void LinkBus::publish(int group, int slot, float level) noexcept
+{
+    if (group < 1 || group > numGroups || ! juce::isPositiveAndBelow(slot, slotsPerGroup))
+        return;
+
+    auto& s = slots[group - 1][slot];
+    s.level.store(level, std::memory_order_relaxed);
+    s.epochMs.store(juce::Time::getMillisecondCounter(), std::memory_order_release);
+}
+
+float LinkBus::read(int group, int excludeSlot) const noexcept
+{
+    if (group < 1 || group > numGroups)
+        return 0.0f;
+
+    const auto now = juce::Time::getMillisecondCounter();
+    auto combined = 0.0f;
+
+    for (int i = 0; i < slotsPerGroup; ++i)
+    {
+        auto& s = slots[group - 1][i];
+
+        if (i == excludeSlot || ! s.used.load(std::memory_order_relaxed))
+            continue;
+
+        // members that haven't processed a block recently no longer hold the group down
+        const auto epoch = s.epochMs.load(std::memory_order_acquire);
+
+        if (epoch != 0 && now - epoch <= staleMs)
+            combined = juce::jmax(combined, s.level.load(std::memory_order_relaxed));
+    }
+
+    return combined;
+}
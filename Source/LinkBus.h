@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    LinkBus.h
+
+    Process-wide bus that lets instances in the same link group share one
+    detector. Every instance publishes its detector level after each block and
+    reads back the loudest level among the rest of its group before the next,
+    so the group compresses together. Publishing and reading are plain atomic loads and
+    stores (no locks, no waiting), so instances can run on any host thread in
+    any order; a member that stops publishing (bypassed, transport stopped,
+    deleted without leaving) drops out once its last block is too old.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class LinkBus
+{
+public:
+    static constexpr int numGroups = 8;         // groups 1-8, 0 means not linked
+    static constexpr int slotsPerGroup = 32;
+    static constexpr juce::uint32 staleMs = 250;
+
+    static LinkBus& getInstance();
+
+    // claims a slot in a group, or -1 if the group is full (lock-free)
+    int join(int group) noexcept;
+    void leave(int group, int slot) noexcept;
+
+    // wait-free: stores this member's detector level and stamps its block epoch
+    void publish(int group, int slot, float level) noexcept;
+
+    // the loudest level among the group's live members other than excludeSlot (the caller's own
+    // slot, so a member only compresses against the others and a group of one runs as if unlinked)
+    float read(int group, int excludeSlot = -1) const noexcept;
+
+private:
+    LinkBus() = default;
+
+    // one cache line per slot so members on different cores don't false-share
+    struct alignas(64) Slot
+    {
+        std::atomic<bool> used { false };
+        std::atomic<float> level { 0.0f };
+        std::atomic<juce::uint32> epochMs { 0 };    // when the last block was published
+    };
+
+    Slot slots[numGroups][slotsPerGroup];
+
+    JUCE_DECLARE_NON_COPYABLE(LinkBus)
+};
@@ -0,0 +1,506 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+#include <thread>
+
+//==============================================================================
+juce::Result OfflineRenderer::render(const juce::File& input, const juce::File& output,
+                                     const EngineParameters& parameters, const Options& options,
+                                     Report* report)
+{
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> info(wav.createMemoryMappedReader(input));
+
+    if (info == nullptr)
+        return juce::Result::fail("Couldn't open " + input.getFullPathName());
+
+    const auto numChannels = static_cast<int>(info->numChannels);
+    const auto sampleRate = info->sampleRate;
+    const auto length = info->lengthInSamples;
+    const auto blockSize = juce::jmax(1, options.blockSize);
+
+    if (numChannels < 1 || numChannels > ParallelCompressorEngine::maxChannels)
+        return juce::Result::fail("Only mono and stereo files can be rendered");
+
+    if (! createFloatWavFile(output, numChannels, sampleRate, length))
+        return juce::Result::fail("Couldn't create " + output.getFullPathName());
+
+    juce::MemoryMappedFile mappedOutput(output, juce::MemoryMappedFile::readWrite);
+
+    if (mappedOutput.getData() == nullptr)
+        return juce::Result::fail("Couldn't map " + output.getFullPathName());
+
+    auto* outputData = reinterpret_cast<float*>(static_cast<char*>(mappedOutput.getData()) + wavHeaderSize);
+
+    // breakpoint times become sample positions at this file's rate
+    std::unique_ptr<AutomationLanes> automation;
+
+    if (options.automation != nullptr && ! options.automation->isEmpty())
+    {
+        automation = std::make_unique<AutomationLanes>(*options.automation);
+        automation->prepare(sampleRate);
+    }
+
+    // a float file peaking over 0 dBFS gives an unsettled envelope more to scale
+    if (! info->mapEntireFile())
+        return juce::Result::fail("Couldn't map " + input.getFullPathName());
+
+    juce::Range<float> levels[ParallelCompressorEngine::maxChannels];
+    info->readMaxLevels(0, length, levels, numChannels);
+
+    auto peak = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        peak = juce::jmax(peak, levels[ch].getEnd(), -levels[ch].getStart());
+
+    info.reset();
+
+    const auto peakDb = juce::Decibels::gainToDecibels(peak);
+    auto warmUpSamples = calcWarmUpSamples(parameters, sampleRate, options.toleranceDb, peakDb);
+
+    // segments replay the automation's gain and mix ramps (see processRange()), but their envelopes still
+    // have to settle under the slowest and hottest settings it reaches; the lanes are linear between
+    // breakpoints, so those are found at the breakpoints
+    if (automation != nullptr)
+    {
+        for (juce::int64 position = 0; position < length; position = automation->getNextBreakpoint(position))
+        {
+            auto automated = parameters;
+            automation->apply(position, automated);
+            warmUpSamples = juce::jmax(warmUpSamples, calcWarmUpSamples(automated, sampleRate, options.toleranceDb, peakDb));
+        }
+    }
+
+    // no point splitting further than one warm-up per segment, or the pre-roll outweighs the work
+    const auto maxSegments = juce::jmax<juce::int64>(1, length / juce::jmax<juce::int64>(warmUpSamples, blockSize));
+    auto numSegments = options.numSegments > 0 ? options.numSegments : juce::SystemStats::getNumCpus();
+    numSegments = static_cast<int>(juce::jlimit<juce::int64>(1, maxSegments, numSegments));
+
+    // each segment gets its own reader, engine and thread, and writes a disjoint region of the output
+    std::atomic<bool> succeeded { true };
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < numSegments; ++i)
+    {
+        const auto start = length * i / numSegments;
+        const auto end = length * (i + 1) / numSegments;
+
+        workers.emplace_back([&, start, end]
+        {
+            // a fresh thread doesn't flush denormals, and the envelopes' tails would otherwise crawl through them
+            juce::ScopedNoDenormals noDenormals;
+
+            ParallelCompressorEngine engine;
+            engine.setParameters(parameters);
+            engine.prepare(sampleRate, blockSize, numChannels);
+
+            if (! renderSegment(input, outputData, numChannels, engine, automation.get(), start, end, warmUpSamples, blockSize))
+                succeeded = false;
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    if (! succeeded)
+        return juce::Result::fail("Couldn't read " + input.getFullPathName());
+
+    if (report != nullptr)
+    {
+        report->numSegments = numSegments;
+        report->warmUpSamples = warmUpSamples;
+    }
+
+    if (options.verifyAgainstSerial)
+    {
+        const auto errorDb = measureSerialError(input, outputData, numChannels, sampleRate, length, parameters,
+                                                automation.get(), blockSize);
+
+        if (report != nullptr)
+        {
+            report->maxErrorDb = errorDb;
+            report->verified = true;
+        }
+
+        if (errorDb > options.toleranceDb)
+            return juce::Result::fail("Segmented render deviates from the serial render by "
+                                      + juce::String(errorDb, 1) + " dBFS");
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::renderSerial(const juce::File& input, const juce::File& output,
+                                           ParallelCompressorEngine& engine, int blockSize)
+{
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> info(wav.createMemoryMappedReader(input));
+
+    if (info == nullptr)
+        return juce::Result::fail("Couldn't open " + input.getFullPathName());
+
+    const auto numChannels = static_cast<int>(info->numChannels);
+    const auto length = info->lengthInSamples;
+
+    if (numChannels < 1 || numChannels > ParallelCompressorEngine::maxChannels)
+        return juce::Result::fail("Only mono and stereo files can be rendered");
+
+    if (! createFloatWavFile(output, numChannels, info->sampleRate, length))
+        return juce::Result::fail("Couldn't create " + output.getFullPathName());
+
+    juce::MemoryMappedFile mappedOutput(output, juce::MemoryMappedFile::readWrite);
+
+    if (mappedOutput.getData() == nullptr)
+        return juce::Result::fail("Couldn't map " + output.getFullPathName());
+
+    auto* outputData = reinterpret_cast<float*>(static_cast<char*>(mappedOutput.getData()) + wavHeaderSize);
+
+    if (! renderSegment(input, outputData, numChannels, engine, nullptr, 0, length, 0, juce::jmax(1, blockSize)))
+        return juce::Result::fail("Couldn't read " + input.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+juce::int64 OfflineRenderer::calcWarmUpSamples(const EngineParameters& parameters, double sampleRate, float toleranceDb,
+                                               float inputPeakDb)
+{
+    ParallelCompressorEngine engine;
+    engine.setParameters(parameters);
+    engine.prepare(sampleRate, 1, 1);
+
+    // an envelope error is scaled by up to 1/threshold through the gain curve and then by the
+    // output gain, so the envelopes have to settle that much further. Input gain and a peak over
+    // 0 dBFS both count twice: they lift the level the detector starts out wrong by, and the
+    // signal the error lands on
+    const auto headroomDb = juce::jmin(parameters.threshold, parameters.sideThreshold)
+                          - juce::jmax(0.0f, parameters.outputGain)
+                          - 2.0f * juce::jmax(0.0f, parameters.inputGain)
+                          - 2.0f * juce::jmax(0.0f, inputPeakDb);
+
+    return engine.getSettlingSamples(toleranceDb + headroomDb);
+}
+
+//==============================================================================
+juce::Result OfflineRenderer::checkBlockSizeInvariance(const juce::AudioBuffer<float>& input, double sampleRate,
+                                                       const EngineParameters& parameters, float toleranceDb,
+                                                       InvarianceReport* report, int maxBlockSize, int numRandomRenders)
+{
+    const auto numChannels = input.getNumChannels();
+    const auto numSamples = input.getNumSamples();
+
+    if (numChannels < 1 || numChannels > ParallelCompressorEngine::maxChannels)
+        return juce::Result::fail("Only mono and stereo signals can be rendered");
+
+    maxBlockSize = juce::jmax(1, maxBlockSize);
+
+    ParallelCompressorEngine engine;
+    juce::AudioBuffer<float> reference(numChannels, numSamples), rendered(numChannels, numSamples);
+    InvarianceReport result;
+
+    auto renderInto = [&](juce::AudioBuffer<float>& dest, QualityTier tier, const std::function<int()>& nextBlockSize)
+    {
+        dest.makeCopyOf(input, true);
+
+        // same starting point for every render: parameters snapped, envelopes and control phase cleared
+        engine.setParameters(parameters);
+        engine.setQualityTier(tier);
+        engine.prepare(sampleRate, maxBlockSize, numChannels);
+
+        float* channels[ParallelCompressorEngine::maxChannels] = {};
+
+        for (int start = 0; start < numSamples;)
+        {
+            const auto blockSize = juce::jmin(numSamples - start, nextBlockSize());
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch] = dest.getWritePointer(ch, start);
+
+            engine.process(channels, numChannels, blockSize);
+            start += blockSize;
+        }
+
+        ++result.numRenders;
+    };
+
+    auto compare = [&](QualityTier tier, int blockSize)
+    {
+        auto maxError = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* a = reference.getReadPointer(ch);
+            const auto* b = rendered.getReadPointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                maxError = juce::jmax(maxError, std::abs(a[i] - b[i]));
+        }
+
+        const auto errorDb = maxError > 0.0f ? 20.0 * std::log10(static_cast<double>(maxError))
+                                             : -std::numeric_limits<double>::infinity();
+
+        auto& tierErrorDb = result.tierMaxErrorDb[static_cast<size_t>(tier)];
+        tierErrorDb = juce::jmax(tierErrorDb, errorDb);
+
+        if (errorDb > result.maxErrorDb)
+        {
+            result.maxErrorDb = errorDb;
+            result.worstTier = tier;
+            result.worstBlockSize = blockSize;
+        }
+    };
+
+    // fixed seed, so a failure can be reproduced
+    juce::Random random(0x51ce);
+
+    for (int tier = 0; tier < numQualityTiers; ++tier)
+    {
+        const auto qualityTier = static_cast<QualityTier>(tier);
+
+        renderInto(reference, qualityTier, [] { return 1; });
+
+        for (int blockSize = 2; blockSize <= maxBlockSize; ++blockSize)
+        {
+            renderInto(rendered, qualityTier, [blockSize] { return blockSize; });
+            compare(qualityTier, blockSize);
+        }
+
+        for (int i = 0; i < numRandomRenders; ++i)
+        {
+            renderInto(rendered, qualityTier, [&random, maxBlockSize] { return random.nextInt(maxBlockSize + 1); });
+            compare(qualityTier, -1);
+        }
+    }
+
+    if (report != nullptr)
+        *report = result;
+
+    if (result.maxErrorDb > toleranceDb)
+    {
+        static const char* tierNames[] = { "high", "medium", "low" };
+
+        return juce::Result::fail("Output depends on the block size: " + juce::String(result.maxErrorDb, 1) + " dBFS at "
+                                  + (result.worstBlockSize < 0 ? juce::String("random sizes") : juce::String(result.worstBlockSize) + " samples")
+                                  + ", " + tierNames[static_cast<int>(result.worstTier)] + " quality");
+    }
+
+    return juce::Result::ok();
+}
+
+juce::AudioBuffer<float> OfflineRenderer::createReferenceSignal(double sampleRate, int numChannels)
+{
+    const auto numSamples = juce::roundToInt(sampleRate);
+    juce::AudioBuffer<float> signal(numChannels, numSamples);
+    signal.clear();
+
+    juce::Random random(0x7e57);
+    const auto twoPi = juce::MathConstants<double>::twoPi;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* data = signal.getWritePointer(ch);
+
+        // channels differ slightly so the M/S paths see some side signal
+        const auto frequency = 997.0 + 13.0 * ch;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto t = i / sampleRate;
+            auto value = 0.0;
+
+            // 100ms silence, then -6 dBFS bursts switching on and off every 50ms
+            if (t >= 0.1 && t < 0.4 && static_cast<int>(t * 20.0) % 2 == 0)
+                value = 0.5 * std::sin(twoPi * frequency * t);
+
+            // -30 dBFS tone stepping up to -3 dBFS
+            else if (t >= 0.4 && t < 0.7)
+                value = (t < 0.55 ? 0.0316 : 0.708) * std::sin(twoPi * frequency * 0.25 * t);
+
+            // -12 dBFS white noise
+            else if (t >= 0.7)
+                value = 0.25 * (2.0 * random.nextDouble() - 1.0);
+
+            data[i] = static_cast<float>(value);
+        }
+    }
+
+    return signal;
+}
+
+//==============================================================================
+bool OfflineRenderer::processRange(juce::AudioFormatReader& reader, ParallelCompressorEngine& engine, int numChannels,
+                                   const AutomationLanes* automation, juce::int64 from, juce::int64 outputStart,
+                                   juce::int64 end, int blockSize, const BlockCallback& onBlock)
+{
+    juce::AudioBuffer<float> block(numChannels, blockSize);
+    auto parameters = engine.getParameters();
+    auto nextEvent = std::numeric_limits<juce::int64>::max();
+
+    if (automation != nullptr)
+    {
+        // a render from zero starts with the ramps settled at the first automated values. The gain and
+        // mix ramps trail moving automation by up to a ramp length, so a later segment replays every
+        // change before it (no audio, just the smoothers) to start its ramps where a serial render has them
+        automation->apply(0, parameters);
+        engine.setParameters(parameters);
+        engine.reset();
+
+        juce::int64 replayed = 0;
+
+        for (nextEvent = automation->getNextEvent(0); nextEvent <= from; nextEvent = automation->getNextEvent(replayed))
+        {
+            engine.advanceRamps(nextEvent - replayed);
+            replayed = nextEvent;
+            automation->apply(replayed, parameters);
+            engine.setParameters(parameters);
+        }
+
+        engine.advanceRamps(from - replayed);
+    }
+
+    for (auto position = from; position < end;)
+    {
+        // blocks never straddle the end of the warm-up, so output starts exactly at outputStart
+        const auto blockEnd = position < outputStart ? outputStart : end;
+        auto numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize, blockEnd - position));
+
+        if (automation != nullptr)
+        {
+            // split at breakpoints so steps land on their sample, and on a fixed control-rate grid while
+            // ramping; the parameters only change there, so segments and serial renders see the same values
+            if (position == nextEvent)
+            {
+                automation->apply(position, parameters);
+                engine.setParameters(parameters);
+                nextEvent = automation->getNextEvent(position);
+            }
+
+            numSamples = static_cast<int>(juce::jmin<juce::int64>(numSamples, nextEvent - position));
+        }
+
+        if (! reader.read(&block, 0, numSamples, position, true, true))
+            return false;
+
+        engine.process(block.getArrayOfWritePointers(), numChannels, numSamples);
+
+        if (position >= outputStart)
+            onBlock(block, position, numSamples);
+
+        position += numSamples;
+    }
+
+    return true;
+}
+
+bool OfflineRenderer::renderSegment(const juce::File& input, float* outputData, int numChannels,
+                                    ParallelCompressorEngine& engine, const AutomationLanes* automation,
+                                    juce::int64 start, juce::int64 end, juce::int64 warmUpSamples, int blockSize)
+{
+    if (start >= end)
+        return true;
+
+    const auto preRollStart = juce::jmax<juce::int64>(0, start - warmUpSamples);
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(wav.createMemoryMappedReader(input));
+
+    if (reader == nullptr || ! reader->mapSectionOfFile({ preRollStart, end }))
+        return false;
+
+    return processRange(*reader, engine, numChannels, automation, preRollStart, start, end, blockSize,
+                        [&](const juce::AudioBuffer<float>& block, juce::int64 position, int numSamples)
+    {
+        auto* destination = outputData + position * numChannels;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* source = block.getReadPointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i * numChannels + ch] = source[i];
+        }
+    });
+}
+
+double OfflineRenderer::measureSerialError(const juce::File& input, const float* outputData, int numChannels, double sampleRate,
+                                           juce::int64 length, const EngineParameters& parameters,
+                                           const AutomationLanes* automation, int blockSize)
+{
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(wav.createMemoryMappedReader(input));
+
+    if (reader == nullptr || ! reader->mapEntireFile())
+        return std::numeric_limits<double>::infinity();
+
+    ParallelCompressorEngine engine;
+    engine.setParameters(parameters);
+    engine.prepare(sampleRate, blockSize, numChannels);
+
+    float maxError = 0.0f;
+
+    const auto ok = processRange(*reader, engine, numChannels, automation, 0, 0, length, blockSize,
+                                 [&](const juce::AudioBuffer<float>& block, juce::int64 position, int numSamples)
+    {
+        const auto* rendered = outputData + position * numChannels;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* serial = block.getReadPointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+                maxError = juce::jmax(maxError, std::abs(serial[i] - rendered[i * numChannels + ch]));
+        }
+    });
+
+    if (! ok)
+        return std::numeric_limits<double>::infinity();
+
+    return maxError > 0.0f ? 20.0 * std::log10(static_cast<double>(maxError))
+                           : -std::numeric_limits<double>::infinity();
+}
+
+//==============================================================================
+bool OfflineRenderer::createFloatWavFile(const juce::File& file, int numChannels, double sampleRate, juce::int64 length)
+{
+    const auto dataSize = length * numChannels * static_cast<juce::int64>(sizeof(float));
+
+    if (dataSize + wavHeaderSize - 8 > std::numeric_limits<juce::uint32>::max())
+        return false;
+
+    file.deleteFile();
+    juce::FileOutputStream out(file);
+
+    if (! out.openedOk())
+        return false;
+
+    // canonical 44 byte header, so the (little-endian) float data is 4 byte aligned
+    out.write("RIFF", 4);
+    out.writeInt(static_cast<int>(dataSize + wavHeaderSize - 8));
+    out.write("WAVE", 4);
+    out.write("fmt ", 4);
+    out.writeInt(16);
+    out.writeShort(3); // WAVE_FORMAT_IEEE_FLOAT
+    out.writeShort(static_cast<short>(numChannels));
+    out.writeInt(juce::roundToInt(sampleRate));
+    out.writeInt(juce::roundToInt(sampleRate) * numChannels * static_cast<int>(sizeof(float)));
+    out.writeShort(static_cast<short>(numChannels * sizeof(float)));
+    out.writeShort(32);
+    out.write("data", 4);
+    out.writeInt(static_cast<int>(dataSize));
+
+    // size the file up front so the data region can be mapped and written in place
+    if (dataSize > 0)
+    {
+        out.setPosition(wavHeaderSize + dataSize - 1);
+        out.writeByte(0);
+    }
+
+    out.flush();
+    return out.getStatus().wasOk();
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+    Renders a whole WAV file through the engine outside of a host. Long files
+    are split into segments rendered on separate cores; each segment first runs
+    a warm-up over the audio before it so its envelopes match a serial render
+    by the time its output starts. Input and output are memory mapped.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+#include "AutomationLanes.h"
+
+//==============================================================================
+class OfflineRenderer
+{
+public:
+    struct Options
+    {
+        int numSegments = 0;            // 0 = one per core
+        int blockSize = 512;
+        float toleranceDb = -120.0f;    // allowed deviation from a serial render (dBFS)
+        bool verifyAgainstSerial = false;
+        const AutomationLanes* automation = nullptr; // applied sample-accurately on top of the parameters
+    };
+
+    struct Report
+    {
+        int numSegments = 0;
+        juce::int64 warmUpSamples = 0;
+        double maxErrorDb = -std::numeric_limits<double>::infinity(); // measured, if verified
+        bool verified = false;
+    };
+
+    // renders a mono or stereo WAV file into a 32-bit float WAV file
+    static juce::Result render(const juce::File& input, const juce::File& output,
+                               const EngineParameters& parameters, const Options& options,
+                               Report* report = nullptr);
+
+    // renders the whole file on the calling thread, with an engine already prepared for its format
+    static juce::Result renderSerial(const juce::File& input, const juce::File& output,
+                                     ParallelCompressorEngine& engine, int blockSize);
+
+    // warm-up needed so a segment is within toleranceDb of the serial render for these settings,
+    // for input peaking at inputPeakDb (dBFS; only a float file's peak over 0 dBFS adds to it)
+    static juce::int64 calcWarmUpSamples(const EngineParameters& parameters, double sampleRate, float toleranceDb,
+                                         float inputPeakDb = 0.0f);
+
+    //==============================================================================
+    struct InvarianceReport
+    {
+        int numRenders = 0;
+        QualityTier worstTier = QualityTier::high;
+        int worstBlockSize = 0;     // -1 = one of the randomly varying renders
+        double maxErrorDb = -std::numeric_limits<double>::infinity(); // worst deviation from the 1-sample render (dBFS)
+
+        // the same, at each quality tier
+        std::array<double, numQualityTiers> tierMaxErrorDb { -std::numeric_limits<double>::infinity(),
+                                                             -std::numeric_limits<double>::infinity(),
+                                                             -std::numeric_limits<double>::infinity() };
+    };
+
+    // renders the input at every block size from 1 to maxBlockSize and with randomly varying
+    // sizes (0 included), at every quality tier, and compares each render with the one done a
+    // sample at a time; fails if any deviates by more than toleranceDb
+    static juce::Result checkBlockSizeInvariance(const juce::AudioBuffer<float>& input, double sampleRate,
+                                                 const EngineParameters& parameters, float toleranceDb,
+                                                 InvarianceReport* report = nullptr,
+                                                 int maxBlockSize = 4096, int numRandomRenders = 16);
+
+    // a second of deterministic test material: silence, hard-onset tone bursts, a level
+    // step and noise, so attack, release and the gain curve are all exercised
+    static juce::AudioBuffer<float> createReferenceSignal(double sampleRate, int numChannels);
+
+private:
+    using BlockCallback = std::function<void(const juce::AudioBuffer<float>& block, juce::int64 position, int numSamples)>;
+
+    // runs [from, end) of the reader through the engine and hands every block from outputStart on to onBlock
+    static bool processRange(juce::AudioFormatReader& reader, ParallelCompressorEngine& engine, int numChannels,
+                             const AutomationLanes* automation, juce::int64 from, juce::int64 outputStart,
+                             juce::int64 end, int blockSize, const BlockCallback& onBlock);
+
+    static bool renderSegment(const juce::File& input, float* outputData, int numChannels,
+                              ParallelCompressorEngine& engine, const AutomationLanes* automation,
+                              juce::int64 start, juce::int64 end, juce::int64 warmUpSamples, int blockSize);
+
+    static double measureSerialError(const juce::File& input, const float* outputData, int numChannels, double sampleRate,
+                                     juce::int64 length, const EngineParameters& parameters,
+                                     const AutomationLanes* automation, int blockSize);
+
+    static bool createFloatWavFile(const juce::File& file, int numChannels, double sampleRate, juce::int64 length);
+
+    static constexpr int wavHeaderSize = 44;
+};
@@ -0,0 +1,247 @@
+/*
+  ==============================================================================
+
+    ParallelCompressionC.cpp
+
+  ==============================================================================
+*/
+
+#define PC_BUILDING_LIBRARY 1
+#include "ParallelCompressionC.h"
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+struct pc_engine
+{
+    ParallelCompressorEngine engine;
+    int numChannels = 0;    // 0 until prepared
+
+    static constexpr juce::uint32 stateMagic = 0x31534350;     // "PCS1"
+    static constexpr int stateHeaderSize = 2 * sizeof(juce::uint32);
+
+    static int getNumParameters() { return EngineParameters::getParameterIDs().size(); }
+    static bool isValidChannelCount(int n) { return n >= 1 && n <= ParallelCompressorEngine::maxChannels; }
+};
+
+//==============================================================================
+int pc_get_api_version(void)
+{
+    return PC_API_VERSION;
+}
+
+pc_engine* pc_create(void)
+{
+    // builds the static ID list here, so no parameter or state call is the first to allocate it
+    EngineParameters::getParameterIDs();
+
+    return new (std::nothrow) pc_engine();
+}
+
+void pc_destroy(pc_engine* engine)
+{
+    delete engine;
+}
+
+int pc_prepare(pc_engine* engine, double sampleRate, int maxBlockSize, int numChannels)
+{
+    if (engine == nullptr || sampleRate <= 0.0 || maxBlockSize <= 0 || ! pc_engine::isValidChannelCount(numChannels))
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    engine->engine.prepare(sampleRate, maxBlockSize, numChannels);
+    engine->numChannels = numChannels;
+    return PC_OK;
+}
+
+int pc_reset(pc_engine* engine)
+{
+    if (engine == nullptr)
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    engine->engine.reset();
+    return PC_OK;
+}
+
+//==============================================================================
+int pc_get_num_parameters(void)
+{
+    return pc_engine::getNumParameters();
+}
+
+const char* pc_get_parameter_id(int index)
+{
+    if (! juce::isPositiveAndBelow(index, pc_engine::getNumParameters()))
+        return nullptr;
+
+    // points into the static ID list, so it stays valid
+    return EngineParameters::getParameterIDs()[index].toRawUTF8();
+}
+
+int pc_set_parameter(pc_engine* engine, int index, float value)
+{
+    if (engine == nullptr || ! juce::isPositiveAndBelow(index, pc_engine::getNumParameters()))
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    // same smoothing and kernel switching as a parameter change in the plugin
+    auto parameters = engine->engine.getParameters();
+    parameters.set(EngineParameters::getParameterIDs()[index], value);
+    engine->engine.setParameters(parameters);
+    return PC_OK;
+}
+
+float pc_get_parameter(const pc_engine* engine, int index)
+{
+    if (engine == nullptr || ! juce::isPositiveAndBelow(index, pc_engine::getNumParameters()))
+        return 0.0f;
+
+    return engine->engine.getParameters().get(EngineParameters::getParameterIDs()[index]);
+}
+
+//==============================================================================
+int pc_process_planar(pc_engine* engine, float* const* channels, int numChannels, int numSamples)
+{
+    if (engine == nullptr || channels == nullptr || ! pc_engine::isValidChannelCount(numChannels) || numSamples < 0)
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    if (engine->numChannels == 0)
+        return PC_ERROR_NOT_PREPARED;
+
+    // the caller's thread may not have denormals flushed the way a plugin host's audio thread does
+    juce::ScopedNoDenormals noDenormals;
+    engine->engine.process(channels, numChannels, numSamples);
+    return PC_OK;
+}
+
+int pc_process_interleaved(pc_engine* engine, float* samples, int numChannels, int numFrames)
+{
+    if (engine == nullptr || samples == nullptr || ! pc_engine::isValidChannelCount(numChannels) || numFrames < 0)
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    if (engine->numChannels == 0)
+        return PC_ERROR_NOT_PREPARED;
+
+    juce::ScopedNoDenormals noDenormals;
+
+    // deinterleave through the engine's scratch arena, one scratch-sized chunk at a time
+    auto& e = engine->engine;
+    float* planar[ParallelCompressorEngine::maxChannels];
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        planar[ch] = e.getScratch(ch);
+
+    for (int start = 0; start < numFrames;)
+    {
+        const auto numToProcess = juce::jmin(numFrames - start, e.getScratchSize());
+        auto* frames = samples + static_cast<size_t>(start) * static_cast<size_t>(numChannels);
+
+        for (int i = 0; i < numToProcess; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                planar[ch][i] = frames[i * numChannels + ch];
+
+        e.process(planar, numChannels, numToProcess);
+
+        for (int i = 0; i < numToProcess; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                frames[i * numChannels + ch] = planar[ch][i];
+
+        start += numToProcess;
+    }
+
+    return PC_OK;
+}
+
+int pc_process_batch(const pc_stream* streams, int numStreams)
+{
+    if (streams == nullptr || numStreams < 0)
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    juce::ScopedNoDenormals noDenormals;
+    auto result = PC_OK;
+
+    for (int i = 0; i < numStreams; ++i)
+    {
+        const auto& stream = streams[i];
+        const auto streamResult = pc_process_planar(stream.engine, stream.channels, stream.num_channels, stream.num_samples);
+
+        if (result == PC_OK)
+            result = streamResult;
+    }
+
+    return result;
+}
+
+//==============================================================================
+int pc_get_state_size(void)
+{
+    return pc_engine::stateHeaderSize + pc_engine::getNumParameters() * static_cast<int>(sizeof(float));
+}
+
+int pc_get_state(const pc_engine* engine, void* dest, int destSize)
+{
+    if (engine == nullptr || dest == nullptr || destSize < pc_get_state_size())
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    auto* out = static_cast<char*>(dest);
+    const auto& ids = EngineParameters::getParameterIDs();
+    const auto& parameters = engine->engine.getParameters();
+
+    auto writeInt = [&out](juce::uint32 value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(out, &value, sizeof(value));
+        out += sizeof(value);
+    };
+
+    writeInt(pc_engine::stateMagic);
+    writeInt(static_cast<juce::uint32>(ids.size()));
+
+    for (auto& id : ids)
+    {
+        const auto value = parameters.get(id);
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeInt(bits);
+    }
+
+    return pc_get_state_size();
+}
+
+int pc_set_state(pc_engine* engine, const void* source, int sourceSize)
+{
+    if (engine == nullptr || source == nullptr || sourceSize < pc_engine::stateHeaderSize)
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    auto* in = static_cast<const char*>(source);
+
+    auto readInt = [&in]()
+    {
+        juce::uint32 value;
+        std::memcpy(&value, in, sizeof(value));
+        in += sizeof(value);
+        return juce::ByteOrder::swapIfBigEndian(value);
+    };
+
+    if (readInt() != pc_engine::stateMagic)
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    // states from builds with fewer parameters leave the newer ones untouched
+    const auto& ids = EngineParameters::getParameterIDs();
+    const auto numStored = readInt();
+
+    if (numStored > static_cast<juce::uint32>(sourceSize - pc_engine::stateHeaderSize) / sizeof(float))
+        return PC_ERROR_INVALID_ARGUMENT;
+
+    auto parameters = engine->engine.getParameters();
+
+    for (juce::uint32 i = 0; i < numStored; ++i)
+    {
+        const auto bits = readInt();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        if (i < static_cast<juce::uint32>(ids.size()))
+            parameters.set(ids[(int) i], value);
+    }
+
+    engine->engine.setParameters(parameters);
+    return PC_OK;
+}
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    ParallelCompressionC.h
+
+    Plain C interface to ParallelCompressorEngine, for hosts that aren't
+    plugin hosts (render servers, scripting languages). An engine is created
+    and prepared once; after pc_prepare() nothing here allocates, so every
+    process, parameter and state call is safe on a real-time thread.
+
+    Parameters are addressed by index, in the same units as the plugin. The
+    indices follow EngineParameters::getParameterIDs(), which is the plugin's
+    parameter layout without the per-instance "quality" and "link group"
+    parameters, so look them up by ID (pc_get_parameter_id) rather than
+    counting plugin parameters. New parameters are only ever appended, so an
+    index stays valid across versions. Channel counts are 1 or 2.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined (_WIN32)
+ #if defined (PC_BUILDING_LIBRARY)
+  #define PC_API __declspec(dllexport)
+ #else
+  #define PC_API __declspec(dllimport)
+ #endif
+#else
+ #define PC_API __attribute__((visibility("default")))
+#endif
+
+#define PC_API_VERSION 1
+
+// return codes
+#define PC_OK                       0
+#define PC_ERROR_INVALID_ARGUMENT  -1
+#define PC_ERROR_NOT_PREPARED      -2
+
+typedef struct pc_engine pc_engine;
+
+// one independent stream for pc_process_batch (planar, processed in place)
+typedef struct pc_stream
+{
+    pc_engine* engine;
+    float* const* channels;
+    int num_channels;
+    int num_samples;
+} pc_stream;
+
+PC_API int pc_get_api_version (void);
+
+//==============================================================================
+// lifetime
+PC_API pc_engine* pc_create (void);
+PC_API void pc_destroy (pc_engine* engine);
+
+// allocates everything the engine will need; max_block_size bounds pc_process_interleaved chunks only
+PC_API int pc_prepare (pc_engine* engine, double sample_rate, int max_block_size, int num_channels);
+
+// clears the envelopes and filter state, keeping the parameters
+PC_API int pc_reset (pc_engine* engine);
+
+//==============================================================================
+// parameters
+PC_API int pc_get_num_parameters (void);
+PC_API const char* pc_get_parameter_id (int index);
+
+PC_API int pc_set_parameter (pc_engine* engine, int index, float value);
+PC_API float pc_get_parameter (const pc_engine* engine, int index);
+
+//==============================================================================
+// processing (in place)
+PC_API int pc_process_planar (pc_engine* engine, float* const* channels, int num_channels, int num_samples);
+PC_API int pc_process_interleaved (pc_engine* engine, float* samples, int num_channels, int num_frames);
+
+// processes every stream, returning PC_OK or the first error (the other streams are still processed)
+PC_API int pc_process_batch (const pc_stream* streams, int num_streams);
+
+//==============================================================================
+// state: every parameter as a fixed-size little-endian block
+PC_API int pc_get_state_size (void);
+PC_API int pc_get_state (const pc_engine* engine, void* dest, int dest_size);
+PC_API int pc_set_state (pc_engine* engine, const void* source, int source_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,453 @@
+/*
+  ==============================================================================
+
+    ParallelCompressorEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+const juce::StringArray& EngineParameters::getParameterIDs()
+{
+    static const juce::StringArray ids { "input gain", "threshold", "ratio", "attack", "release", "output gain", "mixer",
+                                         "stereo mode", "side threshold", "side ratio", "side mixer",
+                                         "dyn eq", "dyn eq freq", "dyn eq q", "dyn eq range", "auto release" };
+    return ids;
+}
+
+bool EngineParameters::set(const juce::String& parameterID, float value)
+{
+    if (parameterID == "input gain")           inputGain = value;
+    else if (parameterID == "threshold")       threshold = value;
+    else if (parameterID == "ratio")           ratio = juce::jmax(1.0f, value);
+    else if (parameterID == "attack")          attack = value;
+    else if (parameterID == "release")         release = value;
+    else if (parameterID == "output gain")     outputGain = value;
+    else if (parameterID == "mixer")           mixer = value;
+    else if (parameterID == "stereo mode")     stereoMode = static_cast<StereoMode>(juce::jlimit(0, 3, juce::roundToInt(value)));
+    else if (parameterID == "side threshold")  sideThreshold = value;
+    else if (parameterID == "side ratio")      sideRatio = juce::jmax(1.0f, value);
+    else if (parameterID == "side mixer")      sideMixer = value;
+    else if (parameterID == "dyn eq")          dynamicEq = value >= 0.5f;
+    else if (parameterID == "dyn eq freq")     dynamicEqFrequency = juce::jmax(1.0f, value);
+    else if (parameterID == "dyn eq q")        dynamicEqQ = juce::jmax(0.01f, value);
+    else if (parameterID == "dyn eq range")    dynamicEqRange = value;
+    else if (parameterID == "auto release")    autoRelease = value >= 0.5f;
+    else                                       return false;
+
+    return true;
+}
+
+float EngineParameters::get(const juce::String& parameterID) const
+{
+    if (parameterID == "input gain")      return inputGain;
+    if (parameterID == "threshold")       return threshold;
+    if (parameterID == "ratio")           return ratio;
+    if (parameterID == "attack")          return attack;
+    if (parameterID == "release")         return release;
+    if (parameterID == "output gain")     return outputGain;
+    if (parameterID == "mixer")           return mixer;
+    if (parameterID == "stereo mode")     return static_cast<float>(stereoMode);
+    if (parameterID == "side threshold")  return sideThreshold;
+    if (parameterID == "side ratio")      return sideRatio;
+    if (parameterID == "side mixer")      return sideMixer;
+    if (parameterID == "dyn eq")          return dynamicEq ? 1.0f : 0.0f;
+    if (parameterID == "dyn eq freq")     return dynamicEqFrequency;
+    if (parameterID == "dyn eq q")        return dynamicEqQ;
+    if (parameterID == "dyn eq range")    return dynamicEqRange;
+    if (parameterID == "auto release")    return autoRelease ? 1.0f : 0.0f;
+
+    jassertfalse;
+    return 0.0f;
+}
+
+//==============================================================================
+float ParallelCompressorEngine::calcAttack(float value)
+{
+    float returnvalue = 3;
+    returnvalue += value * 3;
+    return returnvalue;
+    // returns 3-33ms
+}
+
+float ParallelCompressorEngine::calcRelease(float value)
+{
+    float rvalue = 0;
+    rvalue = 50 + (value * 25);
+    return rvalue;
+    // returns 50-300ms
+}
+
+//==============================================================================
+void ParallelCompressorEngine::prepare(double sampleRate, int maximumBlockSize, int newNumChannels)
+{
+    jassert(newNumChannels > 0 && newNumChannels <= maxChannels);
+
+    numChannels = juce::jlimit(1, maxChannels, newNumChannels);
+
+    // all scratch comes out of one block, reallocated only when the block size grows,
+    // with each channel's run rounded up to whole cache lines
+    constexpr auto floatsPerLine = static_cast<int>(arenaAlignment / sizeof(float));
+    scratchSize = juce::jmax(1, maximumBlockSize);
+    const auto channelStride = static_cast<size_t>((scratchSize + floatsPerLine - 1) / floatsPerLine * floatsPerLine);
+    const auto bytesNeeded = channelStride * maxChannels * sizeof(float) + arenaAlignment;
+
+    if (bytesNeeded > arenaBytes)
+    {
+        arena.allocate(bytesNeeded, true);
+        arenaBytes = bytesNeeded;
+    }
+
+    auto* base = juce::snapPointerToAlignment(reinterpret_cast<float*>(arena.get()), arenaAlignment);
+
+    for (size_t ch = 0; ch < scratch.size(); ++ch)
+        scratch[ch] = base + ch * channelStride;
+
+    // same ramp lengths as the juce::dsp::Gain and DryWetMixer this replaces
+    state.inputGain.reset(sampleRate, gainRampSeconds);
+    state.outputGain.reset(sampleRate, gainRampSeconds);
+    state.mix.reset(sampleRate, mixRampSeconds);
+    state.sideMix.reset(sampleRate, mixRampSeconds);
+
+    state.comp.prepare(sampleRate);
+    state.sideComp.prepare(sampleRate);
+    state.band.prepare(sampleRate);
+
+    kernel = selectKernel(numChannels, parameters, qualityTier);
+    reset();
+}
+
+void ParallelCompressorEngine::reset()
+{
+    state.comp.reset();
+    state.sideComp.reset();
+    state.band.reset();
+    state.controlPhase = 0;
+
+    // start from the current settings rather than ramping in from silence
+    state.inputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(parameters.inputGain));
+    state.outputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(parameters.outputGain));
+    state.mix.setCurrentAndTargetValue(parameters.mixer / 100);
+    state.sideMix.setCurrentAndTargetValue(parameters.sideMixer / 100);
+}
+
+void ParallelCompressorEngine::setParameters(const EngineParameters& newParameters)
+{
+    // connected gains
+    state.inputGain.setTargetValue(juce::Decibels::decibelsToGain(newParameters.inputGain));
+    state.outputGain.setTargetValue(juce::Decibels::decibelsToGain(newParameters.outputGain));
+
+    // connected compressor parameters
+    state.comp.setThreshold(newParameters.threshold);
+    state.comp.setRatio(newParameters.ratio);
+    state.comp.setAttack(calcAttack(newParameters.attack));
+    state.comp.setRelease(calcRelease(newParameters.release));
+    state.comp.setAutoRelease(newParameters.autoRelease);
+
+    // connected side compressor parameters (M/S modes only)
+    state.sideComp.setThreshold(newParameters.sideThreshold);
+    state.sideComp.setRatio(newParameters.sideRatio);
+    state.sideComp.setAttack(calcAttack(newParameters.attack));
+    state.sideComp.setRelease(calcRelease(newParameters.release));
+    state.sideComp.setAutoRelease(newParameters.autoRelease);
+
+    // connected dynamic eq band (detects against the main threshold and ratio)
+    state.band.setFrequency(newParameters.dynamicEqFrequency);
+    state.band.setQ(newParameters.dynamicEqQ);
+    state.band.setRange(newParameters.dynamicEqRange);
+    state.band.setThreshold(newParameters.threshold);
+    state.band.setRatio(newParameters.ratio);
+    state.band.setAttack(calcAttack(newParameters.attack));
+    state.band.setRelease(calcRelease(newParameters.release));
+    state.band.setAutoRelease(newParameters.autoRelease);
+
+    // connected mix parameters
+    state.mix.setTargetValue(newParameters.mixer / 100);
+    state.sideMix.setTargetValue(newParameters.sideMixer / 100);
+
+    // the kernel only changes with the stereo mode, the band switch or the release mode, never inside the sample loop
+    if ((newParameters.stereoMode != parameters.stereoMode || newParameters.dynamicEq != parameters.dynamicEq
+         || newParameters.autoRelease != parameters.autoRelease) && numChannels > 0)
+    {
+        // a band switched back on starts from silence rather than a stale state
+        if (newParameters.dynamicEq && ! parameters.dynamicEq)
+            state.band.reset();
+
+        kernel = selectKernel(numChannels, newParameters, qualityTier);
+    }
+
+    parameters = newParameters;
+}
+
+void ParallelCompressorEngine::applySettingsFrom(const ParallelCompressorEngine& prepared) noexcept
+{
+    const auto running = state;
+
+    state = prepared.state;
+    state.comp.copyRunningState(running.comp);
+    state.sideComp.copyRunningState(running.sideComp);
+    state.band.copyRunningState(running.band);
+    state.controlPhase = running.controlPhase;
+
+    // a band that was off has no meaningful state to carry on from
+    if (prepared.parameters.dynamicEq && ! parameters.dynamicEq)
+        state.band.reset();
+
+    parameters = prepared.parameters;
+
+    if (numChannels > 0)
+        kernel = selectKernel(numChannels, parameters, qualityTier);
+}
+
+void ParallelCompressorEngine::copyStateFrom(const ParallelCompressorEngine& other) noexcept
+{
+    jassert(other.numChannels == numChannels);
+
+    state = other.state;
+    kernel = other.kernel;
+    qualityTier = other.qualityTier;
+    parameters = other.parameters;
+}
+
+void ParallelCompressorEngine::setQualityTier(QualityTier newTier)
+{
+    if (newTier == qualityTier)
+        return;
+
+    qualityTier = newTier;
+    state.controlPhase = 0;
+
+    if (numChannels > 0)
+        kernel = selectKernel(numChannels, parameters, qualityTier);
+}
+
+void ParallelCompressorEngine::process(float* const* channels, int numChannelsToProcess, int numSamples) noexcept
+{
+    if (kernel == nullptr || numSamples <= 0 || numChannelsToProcess <= 0)
+        return;
+
+    // a host handing over a different layout than was prepared gets the matching kernel for this call
+    auto kernelToUse = kernel;
+
+    if (numChannelsToProcess != numChannels)
+        kernelToUse = selectKernel(juce::jlimit(1, maxChannels, numChannelsToProcess), parameters, qualityTier);
+
+    // the kernels step the linked level every sample, so a call running past the end of its ramp
+    // is split there and the rest runs with the level settled
+    const auto rampSamples = state.comp.getLinkedRampRemaining();
+
+    if (rampSamples > 0 && rampSamples < numSamples)
+    {
+        (this->*kernelToUse)(channels, rampSamples);
+        state.comp.advanceLinkedRamp(rampSamples);
+
+        float* rest[maxChannels] = {};
+
+        for (int ch = 0; ch < juce::jmin(numChannelsToProcess, maxChannels); ++ch)
+            rest[ch] = channels[ch] + rampSamples;
+
+        (this->*kernelToUse)(rest, numSamples - rampSamples);
+        return;
+    }
+
+    (this->*kernelToUse)(channels, numSamples);
+    state.comp.advanceLinkedRamp(numSamples);
+}
+
+void ParallelCompressorEngine::advanceRamps(juce::int64 numSamples) noexcept
+{
+    // only the M/S kernels step the side mix
+    const auto sideMixRuns = numChannels == 2 && parameters.stereoMode != StereoMode::leftRight;
+
+    for (juce::int64 i = 0; i < numSamples; ++i)
+    {
+        if (! (state.inputGain.isSmoothing() || state.outputGain.isSmoothing() || state.mix.isSmoothing()
+               || (sideMixRuns && state.sideMix.isSmoothing())))
+            return;
+
+        state.inputGain.getNextValue();
+        state.outputGain.getNextValue();
+        state.mix.getNextValue();
+
+        if (sideMixRuns)
+            state.sideMix.getNextValue();
+    }
+}
+
+juce::int64 ParallelCompressorEngine::getSettlingSamples(float toleranceDb) const
+{
+    // the gain and mix ramps start at their targets after reset, so only the envelopes (and the band's filter) matter
+    auto coefficient = juce::jmax(state.comp.getSlowestCoefficient(), state.sideComp.getSlowestCoefficient());
+
+    if (parameters.dynamicEq)
+        coefficient = juce::jmax(coefficient, state.band.getSlowestCoefficient());
+
+    if (coefficient <= 0.0f)
+        return 0;
+
+    const auto tolerance = juce::jmax(juce::Decibels::decibelsToGain(toleranceDb, -240.0f), 1.0e-12f);
+
+    if (tolerance >= 1.0f)
+        return 0;
+
+    return static_cast<juce::int64>(std::ceil(std::log(tolerance) / std::log(coefficient)));
+}
+
+//==============================================================================
+template <int GainInterval, bool AutoRelease>
+float ParallelCompressorEngine::compressSample(CompressorCore& core, int channel, float input) noexcept
+{
+    if constexpr (GainInterval == 1)
+        return core.processSample<AutoRelease>(channel, input);
+    else
+        return core.processSampleControlRate<AutoRelease>(channel, input);
+}
+
+template <int NumChannels, StereoMode Mode, int GainInterval, bool DynamicEq, bool AutoRelease>
+void ParallelCompressorEngine::processKernel(float* const* channels, int numSamples) noexcept
+{
+    static_assert(NumChannels > 0 && NumChannels <= maxChannels, "unsupported channel count");
+    static_assert(Mode == StereoMode::leftRight || NumChannels == 2, "M/S needs a stereo pair");
+
+    float* data[NumChannels];
+
+    for (int ch = 0; ch < NumChannels; ++ch)
+        data[ch] = channels[ch];
+
+    for (int start = 0; start < numSamples;)
+    {
+        auto end = numSamples;
+
+        // at reduced quality, split into runs that end on the control grid so the
+        // per-sample loop itself stays branch-free
+        if constexpr (GainInterval > 1)
+        {
+            if (state.controlPhase == 0)
+            {
+                for (int ch = 0; ch < NumChannels; ++ch)
+                    state.comp.startControlInterval(ch, GainInterval);
+
+                if constexpr (Mode != StereoMode::leftRight)
+                    state.sideComp.startControlInterval(0, GainInterval);
+
+                if constexpr (DynamicEq)
+                    for (int ch = 0; ch < NumChannels; ++ch)
+                        state.band.startControlInterval(ch, GainInterval);
+            }
+
+            end = juce::jmin(numSamples, start + GainInterval - state.controlPhase);
+            state.controlPhase = (state.controlPhase + end - start) % GainInterval;
+        }
+
+        for (int i = start; i < end; ++i)
+        {
+            const auto inGain = state.inputGain.getNextValue();
+            const auto outGain = state.outputGain.getNextValue();
+            const auto wet = state.mix.getNextValue();
+            state.comp.stepLinkedLevel();
+
+            if constexpr (Mode == StereoMode::leftRight)
+            {
+                // unrolled across the channels since NumChannels is a constant
+                for (int ch = 0; ch < NumChannels; ++ch)
+                {
+                    const auto dry = data[ch][i];
+                    auto wetIn = dry * inGain;
+
+                    if constexpr (DynamicEq)
+                        wetIn = state.band.processSample<GainInterval, AutoRelease>(ch, wetIn);
+
+                    const auto compressed = compressSample<GainInterval, AutoRelease>(state.comp, ch, wetIn) * outGain;
+                    data[ch][i] = dry + wet * (compressed - dry);
+                }
+            }
+            else
+            {
+                // mid and side have their own thresholds, ratios and mixes, so they run through two
+                // cores rather than two lanes of one: unlike the L/R loop above, which walks one core's
+                // per-channel state arrays and can vectorise across the pair, these are two scalar
+                // envelope recursions. The encode and decode still cost no passes of their own
+                const auto sideWet = state.sideMix.getNextValue();
+
+                // M/S encode (this is also the dry signal for the mixer)
+                const auto mid = 0.5f * (data[0][i] + data[1][i]);
+                const auto side = 0.5f * (data[0][i] - data[1][i]);
+
+                auto midOut = mid;
+                auto sideOut = side;
+
+                if constexpr (Mode != StereoMode::sideOnly)
+                {
+                    auto wetIn = mid * inGain;
+
+                    if constexpr (DynamicEq)
+                        wetIn = state.band.processSample<GainInterval, AutoRelease>(0, wetIn);
+
+                    midOut += wet * (compressSample<GainInterval, AutoRelease>(state.comp, 0, wetIn) * outGain - mid);
+                }
+
+                if constexpr (Mode != StereoMode::midOnly)
+                {
+                    auto wetIn = side * inGain;
+
+                    if constexpr (DynamicEq)
+                        wetIn = state.band.processSample<GainInterval, AutoRelease>(1, wetIn);
+
+                    sideOut += sideWet * (compressSample<GainInterval, AutoRelease>(state.sideComp, 0, wetIn) * outGain - side);
+                }
+
+                // M/S decode straight back into the output
+                data[0][i] = midOut + sideOut;
+                data[1][i] = midOut - sideOut;
+            }
+        }
+
+        start = end;
+    }
+}
+
+template <int NumChannels, StereoMode Mode, bool DynamicEq, bool AutoRelease>
+constexpr ParallelCompressorEngine::TierKernels ParallelCompressorEngine::kernelsForTiers()
+{
+    // gain computer every 1, 4 and 16 samples
+    return { &ParallelCompressorEngine::processKernel<NumChannels, Mode, 1, DynamicEq, AutoRelease>,
+             &ParallelCompressorEngine::processKernel<NumChannels, Mode, 4, DynamicEq, AutoRelease>,
+             &ParallelCompressorEngine::processKernel<NumChannels, Mode, 16, DynamicEq, AutoRelease> };
+}
+
+template <int NumChannels, bool DynamicEq, bool AutoRelease>
+constexpr ParallelCompressorEngine::ModeKernels ParallelCompressorEngine::kernelsForModes()
+{
+    // in the order of StereoMode; mono always runs the L/R kernels
+    if constexpr (NumChannels == 1)
+        return { kernelsForTiers<1, StereoMode::leftRight, DynamicEq, AutoRelease>(),
+                 kernelsForTiers<1, StereoMode::leftRight, DynamicEq, AutoRelease>(),
+                 kernelsForTiers<1, StereoMode::leftRight, DynamicEq, AutoRelease>(),
+                 kernelsForTiers<1, StereoMode::leftRight, DynamicEq, AutoRelease>() };
+    else
+        return { kernelsForTiers<NumChannels, StereoMode::leftRight, DynamicEq, AutoRelease>(),
+                 kernelsForTiers<NumChannels, StereoMode::midSide, DynamicEq, AutoRelease>(),
+                 kernelsForTiers<NumChannels, StereoMode::midOnly, DynamicEq, AutoRelease>(),
+                 kernelsForTiers<NumChannels, StereoMode::sideOnly, DynamicEq, AutoRelease>() };
+}
+
+ParallelCompressorEngine::Kernel ParallelCompressorEngine::selectKernel(int numChannels, const EngineParameters& parameters, QualityTier tier)
+{
+    // [auto release off / on][dynamic eq off / on][channels - 1][stereo mode][quality tier]
+    static constexpr ModeKernels kernels[2][2][maxChannels] =
+    {
+        {
+            { kernelsForModes<1, false, false>(), kernelsForModes<2, false, false>() },
+            { kernelsForModes<1, true, false>(),  kernelsForModes<2, true, false>() }
+        },
+        {
+            { kernelsForModes<1, false, true>(),  kernelsForModes<2, false, true>() },
+            { kernelsForModes<1, true, true>(),   kernelsForModes<2, true, true>() }
+        }
+    };
+
+    return kernels[parameters.autoRelease ? 1 : 0][parameters.dynamicEq ? 1 : 0][numChannels - 1]
+                  [static_cast<size_t>(parameters.stereoMode)][static_cast<size_t>(tier)];
+}
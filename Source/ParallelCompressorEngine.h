@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    ParallelCompressorEngine.h
+
+    The DSP chain behind the plugin: input gain, optional dynamic EQ band,
+    compressor, output gain and the dry/wet mix, with the stereo modes fused
+    into one pass. Processing runs through kernels specialised at compile time
+    on channel count, stereo mode, whether the band is on and whether the
+    release is automatic, picked from a dispatch table outside the sample loop.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CompressorCore.h"
+#include "DynamicEqBand.h"
+
+// stereo processing modes, in the order of the "stereo mode" choice parameter
+enum class StereoMode
+{
+    leftRight = 0,
+    midSide,
+    midOnly,
+    sideOnly
+};
+
+static constexpr int numStereoModes = 4;
+
+// how often the gain computer runs: every sample, or every 4 / 16 samples with the gain
+// interpolated in between (the envelope followers always run every sample)
+enum class QualityTier
+{
+    high = 0,
+    medium,
+    low
+};
+
+static constexpr int numQualityTiers = 3;
+
+// parameter values in the same units as the plugin parameters
+struct EngineParameters
+{
+    float inputGain = 0.0f;     // dB
+    float threshold = 0.0f;     // dB
+    float ratio = 3.0f;
+    float attack = 3.0f;        // 0-10 knob
+    float release = 3.0f;       // 0-10 knob
+    bool autoRelease = false;   // program-dependent release around the release setting
+    float outputGain = 0.0f;    // dB
+    float mixer = 100.0f;       // %
+
+    StereoMode stereoMode = StereoMode::leftRight;
+    float sideThreshold = 0.0f; // dB
+    float sideRatio = 3.0f;
+    float sideMixer = 100.0f;   // %
+
+    bool dynamicEq = false;
+    float dynamicEqFrequency = 3500.0f; // Hz
+    float dynamicEqQ = 2.0f;
+    float dynamicEqRange = -6.0f;       // dB, deepest cut
+
+    // access by plugin parameter ID, for anything driving the engine without a treestate
+    bool set(const juce::String& parameterID, float value);
+    float get(const juce::String& parameterID) const;
+
+    // the IDs set() and get() understand: the plugin's parameter layout minus the per-instance
+    // "quality" and "link group"; new IDs go at the end, since the C API and its state use the index
+    static const juce::StringArray& getParameterIDs();
+};
+
+//==============================================================================
+class ParallelCompressorEngine
+{
+public:
+    static constexpr int maxChannels = CompressorCore::maxChannels;
+
+    // ramp lengths of the gain and dry/wet smoothing
+    static constexpr double gainRampSeconds = 0.25;
+    static constexpr double mixRampSeconds = 0.05;
+
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    void setParameters(const EngineParameters& newParameters);
+    const EngineParameters& getParameters() const { return parameters; }
+
+    // switches to settings computed ahead of time by another engine prepared at the same sample
+    // rate (coefficients, gain and mix values, kernel), keeping this engine's envelopes and filter
+    // state and its quality tier; nothing is recalculated, so this is cheap on the audio thread
+    void applySettingsFrom(const ParallelCompressorEngine& prepared) noexcept;
+
+    // becomes a copy of another engine prepared for the same layout, running state included,
+    // e.g. so the outgoing settings can keep running through a crossfade
+    void copyStateFrom(const ParallelCompressorEngine& other) noexcept;
+
+    // switches the gain computer rate; the gain carries on from where it was, so this doesn't click
+    void setQualityTier(QualityTier newTier);
+    QualityTier getQualityTier() const { return qualityTier; }
+
+    // detector sharing between linked instances: the main compressor (mid in M/S)
+    // compresses against the louder of its own envelope and the linked level, which ramps
+    // to a new value over the next rampSamples samples processed
+    void setLinkedLevel(float level, int rampSamples = 0) noexcept { state.comp.setLinkedLevel(level, rampSamples); }
+    float getDetectorLevel() const noexcept
+    {
+        // in the M/S modes the main compressor only runs on channel 0 (mid)
+        return state.comp.getDetectorLevel(parameters.stereoMode == StereoMode::leftRight ? numChannels : 1);
+    }
+
+    // processes the channels in place
+    void process(float* const* channels, int numChannels, int numSamples) noexcept;
+
+    // steps the gain and mix ramps on by numSamples exactly as process() would, without any audio,
+    // so an engine starting partway into a render can pick the ramps up where a full render has them
+    void advanceRamps(juce::int64 numSamples) noexcept;
+
+    // samples of pre-roll after which a freshly reset engine matches one that has been
+    // running all along to within toleranceDb (the envelope followers are contractions)
+    juce::int64 getSettlingSamples(float toleranceDb) const;
+
+    // per-channel scratch of maximumBlockSize samples, aligned for SIMD, so callers can stage
+    // audio around process() (interleaving, crossfades) without allocating after prepare()
+    float* getScratch(int channel) const noexcept { return scratch[(size_t) channel]; }
+    int getScratchSize() const noexcept { return scratchSize; }
+
+    // bytes this engine owns, i.e. the object itself plus its scratch arena
+    size_t getMemoryFootprintBytes() const noexcept { return sizeof(*this) + arenaBytes; }
+
+    // functions to calc attack and release times from the 0-10 knobs
+    static float calcAttack(float value);
+    static float calcRelease(float value);
+
+private:
+    using Kernel = void (ParallelCompressorEngine::*)(float* const*, int) noexcept;
+
+    using TierKernels = std::array<Kernel, numQualityTiers>;
+    using ModeKernels = std::array<TierKernels, numStereoModes>;
+
+    template <int NumChannels, StereoMode Mode, int GainInterval, bool DynamicEq, bool AutoRelease>
+    void processKernel(float* const* channels, int numSamples) noexcept;
+
+    template <int GainInterval, bool AutoRelease>
+    static float compressSample(CompressorCore& core, int channel, float input) noexcept;
+
+    template <int NumChannels, StereoMode Mode, bool DynamicEq, bool AutoRelease>
+    static constexpr TierKernels kernelsForTiers();
+
+    template <int NumChannels, bool DynamicEq, bool AutoRelease>
+    static constexpr ModeKernels kernelsForModes();
+
+    static Kernel selectKernel(int numChannels, const EngineParameters& parameters, QualityTier tier);
+
+    // everything the kernels read and write per sample, packed together at the front of the
+    // engine and starting on a cache line (the envelopes come first inside each CompressorCore)
+    struct alignas(64) DspState
+    {
+        CompressorCore comp, sideComp;
+        DynamicEqBand band;     // channel 0 / 1 are left / right, or mid / side in the M/S modes
+        juce::SmoothedValue<float> inputGain, outputGain, mix, sideMix;
+        int controlPhase = 0;   // position inside the current gain control interval, carried across blocks
+    };
+
+    DspState state;
+
+    // touched once per block
+    Kernel kernel = nullptr;
+    int numChannels = 0;
+    QualityTier qualityTier = QualityTier::high;
+
+    // scratch arena: one allocation made in prepare(), one cache-aligned run per channel
+    static constexpr size_t arenaAlignment = 64;
+    juce::HeapBlock<char> arena;
+    size_t arenaBytes = 0;
+    std::array<float*, maxChannels> scratch {};
+    int scratchSize = 0;
+
+    // only touched when the parameters change
+    EngineParameters parameters;
+};
@@ -12,14 +12,30 @@
 //==============================================================================
 ParallelCompressionAudioProcessorEditor::ParallelCompressionAudioProcessorEditor (ParallelCompressionAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p), waveZoom(), channelToggle(), ingainSlider(), outgainSlider(),
-    compThreshold(), compRatio(), compAttack(), compRelease(), mixSlider(),
+    compThreshold(), compRatio(), compAttack(), compRelease(), mixSlider(), sideThreshold(), sideRatio(), sideMixSlider(),
+    dynEqFreq(), dynEqQ(), dynEqRange(),
     ingainSliderAttachment(audioProcessor.treestate, "input gain", ingainSlider),
     outgainSliderAttachment(audioProcessor.treestate, "output gain", outgainSlider),
     compThresholdAttachment(audioProcessor.treestate, "threshold", compThreshold),
     compRatioAttachment(audioProcessor.treestate, "ratio", compRatio),
     compAttackAttachment(audioProcessor.treestate, "attack", compAttack),
     compReleaseAttachment(audioProcessor.treestate, "release", compRelease),
-    compMixAttachment(audioProcessor.treestate, "mixer", mixSlider)
+    compMixAttachment(audioProcessor.treestate, "mixer", mixSlider),
+    sideThresholdAttachment(audioProcessor.treestate, "side threshold", sideThreshold),
+    sideRatioAttachment(audioProcessor.treestate, "side ratio", sideRatio),
+    sideMixAttachment(audioProcessor.treestate, "side mixer", sideMixSlider),
+    linkGroupAttachment(audioProcessor.treestate, "link group", linkGroupSlider),
+    dynEqFreqAttachment(audioProcessor.treestate, "dyn eq freq", dynEqFreq),
+    dynEqQAttachment(audioProcessor.treestate, "dyn eq q", dynEqQ),
+    dynEqRangeAttachment(audioProcessor.treestate, "dyn eq range", dynEqRange),
+    stereoModeAttachment(audioProcessor.treestate, "stereo mode", stereoModeBox),
+    qualityAttachment(audioProcessor.treestate, "quality", qualityBox),
+    dynEqAttachment(audioProcessor.treestate, "dyn eq", dynEqToggle),
+    autoReleaseAttachment(audioProcessor.treestate, "auto release", autoReleaseToggle),
+    spectrumDisplay(audioProcessor.analyzer)
+   #if PARALLEL_COMPRESSION_TRACING
+    , traceHistogram(audioProcessor.tracer)
+   #endif
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -36,6 +52,8 @@ ParallelCompressionAudioProcessorEditor::ParallelCompressionAudioProcessorEditor
     // connection to audioprocessor
     waveZoom.onValueChange = [this]()
     {
+        // resizing reallocates the viewer's buffers, so keep pushBuffer() out while it happens
+        const juce::ScopedLock lock(audioProcessor.getCallbackLock());
         audioProcessor.waveViewer.setBufferSize(waveZoom.getValue());
     };
     // toggle to make the waveform viewer stereo instead of mono
@@ -43,6 +61,7 @@ ParallelCompressionAudioProcessorEditor::ParallelCompressionAudioProcessorEditor
     channelToggle.setButtonText("Stereo");
     channelToggle.onClick = [this]()
     {
+        const juce::ScopedLock lock(audioProcessor.getCallbackLock());
         channelToggle.getToggleState() ? audioProcessor.waveViewer.setNumChannels(2) : audioProcessor.waveViewer.setNumChannels(1);
     };
 
@@ -94,6 +113,10 @@ ParallelCompressionAudioProcessorEditor::ParallelCompressionAudioProcessorEditor
     releaseLabel.setText("Release", juce::dontSendNotification);
     releaseLabel.attachToComponent(&compRelease, true);
 
+    // auto release (the knob then sets the centre of the program-dependent release)
+    addAndMakeVisible(autoReleaseToggle);
+    autoReleaseToggle.setButtonText("Auto Release");
+
     // mix knob (parallel compression)
     addAndMakeVisible(mixSlider);
     mixSlider.setTextValueSuffix(" %");
@@ -102,11 +125,114 @@ ParallelCompressionAudioProcessorEditor::ParallelCompressionAudioProcessorEditor
     mixLabel.setText("Mix", juce::dontSendNotification);
     mixLabel.attachToComponent(&mixSlider, true);
 
-    setSize (800, 400);
+    // stereo mode selector (the attachment is built before the items exist, so sync the selection here)
+    addAndMakeVisible(stereoModeBox);
+    stereoModeBox.addItemList(audioProcessor.treestate.getParameter("stereo mode")->getAllValueStrings(), 1);
+    stereoModeBox.setSelectedItemIndex(static_cast<int>(*audioProcessor.treestate.getRawParameterValue("stereo mode")), juce::dontSendNotification);
+    addAndMakeVisible(stereoModeLabel);
+    stereoModeLabel.setText("Stereo", juce::dontSendNotification);
+    stereoModeLabel.attachToComponent(&stereoModeBox, true);
+
+    // side threshold knob (M/S modes)
+    addAndMakeVisible(sideThreshold);
+    sideThreshold.setRange(-36.0, 0.0, 1.0);
+    sideThreshold.setTextValueSuffix(" dB");
+    addAndMakeVisible(sideThresholdLabel);
+    sideThresholdLabel.setText("Side Threshold", juce::dontSendNotification);
+    sideThresholdLabel.attachToComponent(&sideThreshold, true);
+
+    // side ratio knob (M/S modes)
+    addAndMakeVisible(sideRatio);
+    sideRatio.setRange(1.0, 12.0, 1.0);
+    sideRatio.setTextValueSuffix(":1");
+    addAndMakeVisible(sideRatioLabel);
+    sideRatioLabel.setText("Side Ratio", juce::dontSendNotification);
+    sideRatioLabel.attachToComponent(&sideRatio, true);
+
+    // side mix knob (M/S modes)
+    addAndMakeVisible(sideMixSlider);
+    sideMixSlider.setTextValueSuffix(" %");
+    sideMixSlider.setRange(0.0, 100.0, 1.0);
+    addAndMakeVisible(sideMixLabel);
+    sideMixLabel.setText("Side Mix", juce::dontSendNotification);
+    sideMixLabel.attachToComponent(&sideMixSlider, true);
+
+    // dynamic eq band switch
+    addAndMakeVisible(dynEqToggle);
+    dynEqToggle.setButtonText("Dynamic EQ");
+
+    // dynamic eq frequency knob
+    addAndMakeVisible(dynEqFreq);
+    dynEqFreq.setTextValueSuffix(" Hz");
+    addAndMakeVisible(dynEqFreqLabel);
+    dynEqFreqLabel.setText("Frequency", juce::dontSendNotification);
+    dynEqFreqLabel.attachToComponent(&dynEqFreq, true);
+
+    // dynamic eq Q knob
+    addAndMakeVisible(dynEqQ);
+    addAndMakeVisible(dynEqQLabel);
+    dynEqQLabel.setText("Q", juce::dontSendNotification);
+    dynEqQLabel.attachToComponent(&dynEqQ, true);
+
+    // dynamic eq range knob (deepest cut)
+    addAndMakeVisible(dynEqRange);
+    dynEqRange.setTextValueSuffix(" dB");
+    addAndMakeVisible(dynEqRangeLabel);
+    dynEqRangeLabel.setText("Range", juce::dontSendNotification);
+    dynEqRangeLabel.attachToComponent(&dynEqRange, true);
+
+    // link group (0 = off)
+    addAndMakeVisible(linkGroupSlider);
+    linkGroupSlider.setSliderStyle(juce::Slider::SliderStyle::IncDecButtons);
+    linkGroupSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 40, 24);
+    linkGroupSlider.setRange(0.0, LinkBus::numGroups, 1.0);
+    addAndMakeVisible(linkGroupLabel);
+    linkGroupLabel.setText("Link Group", juce::dontSendNotification);
+    linkGroupLabel.attachToComponent(&linkGroupSlider, true);
+
+    // quality selector and the tier auto mode is currently running at
+    addAndMakeVisible(qualityBox);
+    qualityBox.addItemList(audioProcessor.treestate.getParameter("quality")->getAllValueStrings(), 1);
+    qualityBox.setSelectedItemIndex(static_cast<int>(*audioProcessor.treestate.getRawParameterValue("quality")), juce::dontSendNotification);
+    addAndMakeVisible(qualityLabel);
+    qualityLabel.setText("Quality", juce::dontSendNotification);
+    qualityLabel.attachToComponent(&qualityBox, true);
+    addAndMakeVisible(qualityStatus);
+    qualityStatus.setFont(juce::Font(12.0f));
+
+    // processBlock time and what this instance holds in memory
+    addAndMakeVisible(engineStats);
+    engineStats.setFont(juce::Font(12.0f));
+    startTimerHz(4);
+
+    // dry vs. compressed spectrum
+    addAndMakeVisible(spectrumDisplay);
+
+   #if PARALLEL_COMPRESSION_TRACING
+    // per-stage processBlock cost (tracing builds only)
+    addAndMakeVisible(traceHistogram);
+   #endif
+
+    setSize (800, 950);
 }
 
 ParallelCompressionAudioProcessorEditor::~ParallelCompressionAudioProcessorEditor()
 {
+    stopTimer();
+}
+
+void ParallelCompressionAudioProcessorEditor::timerCallback()
+{
+    static const char* tierNames[] = { "High", "Medium", "Low" };
+
+    qualityStatus.setText(juce::String(tierNames[static_cast<int>(audioProcessor.getQualityTier())])
+                          + ", load " + juce::String(juce::roundToInt(audioProcessor.getProcessingLoad() * 100.0f)) + "%",
+                          juce::dontSendNotification);
+
+    const auto latency = audioProcessor.getBlockLatency();
+    engineStats.setText("p99 " + juce::String(latency.p99Microseconds, 0) + " / max " + juce::String(latency.maxMicroseconds, 0) + " us\n"
+                        + juce::String(static_cast<double>(audioProcessor.getMemoryFootprintBytes()) / 1024.0, 1) + " KB",
+                        juce::dontSendNotification);
 }
 
 //==============================================================================
@@ -123,11 +249,16 @@ void ParallelCompressionAudioProcessorEditor::paint (juce::Graphics& g)
 void ParallelCompressionAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
-    auto waveViewerArea = bounds.removeFromTop(bounds.getHeight() * 0.5);
+    auto waveViewerArea = bounds.removeFromTop(200);
+    auto spectrumArea = bounds.removeFromBottom(150);
+    auto dynEqArea = bounds.removeFromBottom(200);
+    auto sideArea = bounds.removeFromBottom(200);
 
     audioProcessor.waveViewer.setBounds(waveViewerArea.getCentreX() - 100.0, waveViewerArea.getCentreY() - 100.0, 200.0, 200.0);
     waveZoom.setBounds((audioProcessor.waveViewer.getX() + audioProcessor.waveViewer.getWidth() + 5), audioProcessor.waveViewer.getY(), 128, audioProcessor.waveViewer.getHeight());
     channelToggle.setBounds((waveZoom.getX() + waveZoom.getWidth() + 45), waveViewerArea.getCentreY() - 18, 64, 32);
+    linkGroupSlider.setBounds(channelToggle.getX(), channelToggle.getBottom() + 35, 96, 24);
+    linkGroupLabel.setBounds(linkGroupSlider.getX(), linkGroupSlider.getY() - 25, linkGroupSlider.getWidth(), 25);
 
     outgainSlider.setBounds(audioProcessor.waveViewer.getX() * 0.5, waveViewerArea.getY()+25, 128, waveViewerArea.getHeight()-25);
     outgainLabel.setBounds(outgainSlider.getX() + (outgainSlider.getWidth() * 0.5), waveViewerArea.getY(), outgainSlider.getWidth(), 25);
@@ -144,10 +275,47 @@ void ParallelCompressionAudioProcessorEditor::resized()
     compAttack.setBounds(compRatio.getX() + compRatio.getWidth(), bounds.getY()+25, bounds.getWidth() * 0.20, bounds.getHeight()-25);
     attackLabel.setBounds(compAttack.getX() + 58, bounds.getY(), compAttack.getWidth(), 25);
 
-    compRelease.setBounds(compAttack.getX() + compAttack.getWidth(), bounds.getY()+25, bounds.getWidth() * 0.20, bounds.getHeight()-25);
+    compRelease.setBounds(compAttack.getX() + compAttack.getWidth(), bounds.getY()+25, bounds.getWidth() * 0.20, bounds.getHeight()-49);
     releaseLabel.setBounds(compRelease.getX() + 54, bounds.getY(), compRelease.getWidth(), 25);
+    autoReleaseToggle.setBounds(compRelease.getX() + 30, compRelease.getBottom(), compRelease.getWidth() - 60, 24);
 
     mixSlider.setBounds(compRelease.getX() + compRelease.getWidth(), bounds.getY() + 25, bounds.getWidth() * 0.20, bounds.getHeight() - 25);
     mixLabel.setBounds(mixSlider.getX() + 64, bounds.getY(), mixSlider.getWidth(), 25);
+
+    // bottom row: stereo mode and the side compressor
+    stereoModeBox.setBounds(sideArea.getX() + 20, sideArea.getCentreY() - 12, sideArea.getWidth() * 0.2 - 40, 24);
+    stereoModeLabel.setBounds(stereoModeBox.getX(), stereoModeBox.getY() - 25, stereoModeBox.getWidth(), 25);
+
+    qualityBox.setBounds(stereoModeBox.getX(), stereoModeBox.getBottom() + 30, stereoModeBox.getWidth(), 24);
+    qualityLabel.setBounds(qualityBox.getX(), qualityBox.getY() - 25, qualityBox.getWidth(), 25);
+    qualityStatus.setBounds(qualityBox.getX(), qualityBox.getBottom(), qualityBox.getWidth(), 20);
+    engineStats.setBounds(qualityStatus.getX(), qualityStatus.getBottom(), qualityStatus.getWidth(), 32);
+
+    sideThreshold.setBounds(sideArea.getX() + sideArea.getWidth() * 0.2, sideArea.getY() + 25, sideArea.getWidth() * 0.2, sideArea.getHeight() - 25);
+    sideThresholdLabel.setBounds(sideThreshold.getX() + 30, sideArea.getY(), sideThreshold.getWidth(), 25);
+
+    sideRatio.setBounds(sideThreshold.getX() + sideThreshold.getWidth(), sideArea.getY() + 25, sideArea.getWidth() * 0.2, sideArea.getHeight() - 25);
+    sideRatioLabel.setBounds(sideRatio.getX() + 45, sideArea.getY(), sideRatio.getWidth(), 25);
+
+    sideMixSlider.setBounds(sideRatio.getX() + sideRatio.getWidth(), sideArea.getY() + 25, sideArea.getWidth() * 0.2, sideArea.getHeight() - 25);
+    sideMixLabel.setBounds(sideMixSlider.getX() + 50, sideArea.getY(), sideMixSlider.getWidth(), 25);
+
+    // dynamic eq row
+    dynEqToggle.setBounds(dynEqArea.getX() + 20, dynEqArea.getCentreY() - 12, dynEqArea.getWidth() * 0.2 - 40, 24);
+
+    dynEqFreq.setBounds(dynEqArea.getX() + dynEqArea.getWidth() * 0.2, dynEqArea.getY() + 25, dynEqArea.getWidth() * 0.2, dynEqArea.getHeight() - 25);
+    dynEqFreqLabel.setBounds(dynEqFreq.getX() + 45, dynEqArea.getY(), dynEqFreq.getWidth(), 25);
+
+    dynEqQ.setBounds(dynEqFreq.getX() + dynEqFreq.getWidth(), dynEqArea.getY() + 25, dynEqArea.getWidth() * 0.2, dynEqArea.getHeight() - 25);
+    dynEqQLabel.setBounds(dynEqQ.getX() + 75, dynEqArea.getY(), dynEqQ.getWidth(), 25);
+
+    dynEqRange.setBounds(dynEqQ.getX() + dynEqQ.getWidth(), dynEqArea.getY() + 25, dynEqArea.getWidth() * 0.2, dynEqArea.getHeight() - 25);
+    dynEqRangeLabel.setBounds(dynEqRange.getX() + 55, dynEqArea.getY(), dynEqRange.getWidth(), 25);
+
+    spectrumDisplay.setBounds(spectrumArea.reduced(20, 10));
+
+   #if PARALLEL_COMPRESSION_TRACING
+    traceHistogram.setBounds(sideMixSlider.getRight() + 5, sideArea.getY() + 25, sideArea.getRight() - sideMixSlider.getRight() - 10, 100);
+   #endif
 }
 
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "TraceHistogram.h"
+#include "SpectrumDisplay.h"
 
 struct CustomRotarySlider : juce::Slider
 {
@@ -22,7 +24,7 @@ struct CustomRotarySlider : juce::Slider
 //==============================================================================
 /**
 */
-class ParallelCompressionAudioProcessorEditor  : public juce::AudioProcessorEditor
+class ParallelCompressionAudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
 {
 public:
     ParallelCompressionAudioProcessorEditor (ParallelCompressionAudioProcessor&);
@@ -35,17 +37,24 @@ public:
  
 
 private:
+    void timerCallback() override;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     ParallelCompressionAudioProcessor& audioProcessor;
 
-    juce::Label ingainLabel, outgainLabel, thresholdLabel, ratioLabel, attackLabel, releaseLabel, mixLabel;
+    juce::Label ingainLabel, outgainLabel, thresholdLabel, ratioLabel, attackLabel, releaseLabel, mixLabel,
+        stereoModeLabel, sideThresholdLabel, sideRatioLabel, sideMixLabel, qualityLabel, qualityStatus, engineStats, linkGroupLabel,
+        dynEqFreqLabel, dynEqQLabel, dynEqRangeLabel;
  
-    juce::Slider waveZoom, ingainSlider, outgainSlider;
+    juce::Slider waveZoom, ingainSlider, outgainSlider, linkGroupSlider;
     
-    juce::ToggleButton channelToggle;
+    juce::ToggleButton channelToggle, dynEqToggle, autoReleaseToggle;
+
+    juce::ComboBox stereoModeBox, qualityBox;
     
-    CustomRotarySlider compThreshold, compRatio, compAttack, compRelease, mixSlider;
+    CustomRotarySlider compThreshold, compRatio, compAttack, compRelease, mixSlider,
+        sideThreshold, sideRatio, sideMixSlider, dynEqFreq, dynEqQ, dynEqRange;
     
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
@@ -56,7 +65,23 @@ private:
         compRatioAttachment,
         compAttackAttachment,
         compReleaseAttachment,
-        compMixAttachment;
+        compMixAttachment,
+        sideThresholdAttachment,
+        sideRatioAttachment,
+        sideMixAttachment,
+        linkGroupAttachment,
+        dynEqFreqAttachment,
+        dynEqQAttachment,
+        dynEqRangeAttachment;
+
+    APVTS::ComboBoxAttachment stereoModeAttachment, qualityAttachment;
+    APVTS::ButtonAttachment dynEqAttachment, autoReleaseAttachment;
+
+    SpectrumDisplay spectrumDisplay;
+
+   #if PARALLEL_COMPRESSION_TRACING
+    TraceHistogram traceHistogram;
+   #endif
 
     std::vector<juce::Component*> getComps();
 
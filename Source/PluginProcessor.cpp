@@ -19,47 +19,20 @@ ParallelCompressionAudioProcessor::ParallelCompressionAudioProcessor()
 #endif
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
-    ), treestate(*this, nullptr, "PARMETERS", createParameterLayout()), ingain(), outgain(), comp(), waveViewer(1)
+    ), treestate(*this, nullptr, "PARMETERS", createParameterLayout()), waveViewer(1)
 #endif
 {
     //initialize waveform viewer
     waveViewer.setRepaintRate(39);
     waveViewer.setBufferSize(256);
 
-    treestate.addParameterListener("input gain", this);
-    treestate.addParameterListener("threshold", this);
-    treestate.addParameterListener("ratio", this);
-    treestate.addParameterListener("attack", this);
-    treestate.addParameterListener("release", this);
-    treestate.addParameterListener("output gain", this);
-    treestate.addParameterListener("mixer", this);
-}
+    memoryFootprintBytes = calcMemoryFootprintBytes();
 
-ParallelCompressionAudioProcessor::~ParallelCompressionAudioProcessor()
-{
-    treestate.removeParameterListener("input gain", this);
-    treestate.removeParameterListener("threshold", this);
-    treestate.removeParameterListener("ratio", this);
-    treestate.removeParameterListener("attack", this);
-    treestate.removeParameterListener("release", this);
-    treestate.removeParameterListener("output gain", this);
-    treestate.removeParameterListener("mixer", this);
 }
 
-float ParallelCompressionAudioProcessor::calcAttack(float value)
-{
-    float returnvalue = 3;
-    returnvalue += value * 3;
-    return returnvalue;
-    // returns 3-33ms 
-}
-
-float ParallelCompressionAudioProcessor::calcRelease(float value)
+ParallelCompressionAudioProcessor::~ParallelCompressionAudioProcessor()
 {
-    float rvalue = 0;
-    rvalue = 50 + (value * 25);
-    return rvalue;
-    // returns 50-300ms
+    LinkBus::getInstance().leave(linkGroup, linkSlot);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout ParallelCompressionAudioProcessor::createParameterLayout()
@@ -74,6 +47,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout ParallelCompressionAudioProc
     auto pOutputGain = std::make_unique<juce::AudioParameterFloat>("output gain", "Output Gain", -24.0, 24.0, 0.0);
     auto pMixer = std::make_unique<juce::AudioParameterFloat>("mixer", "Mixer", 0.0, 100.0, 100.0);
 
+    // stereo mode (threshold, ratio and mixer above drive mid when in M/S)
+    auto pStereoMode = std::make_unique<juce::AudioParameterChoice>("stereo mode", "Stereo Mode", juce::StringArray { "L/R", "M/S", "M Only", "S Only" }, 0);
+    auto pSideThreshold = std::make_unique<juce::AudioParameterFloat>("side threshold", "Side Threshold", -36.0, 0.0, 0.0);
+    auto pSideRatio = std::make_unique<juce::AudioParameterFloat>("side ratio", "Side Ratio", 1.0, 10.0, 3.0);
+    auto pSideMixer = std::make_unique<juce::AudioParameterFloat>("side mixer", "Side Mixer", 0.0, 100.0, 100.0);
+
+    // quality (auto follows the cpu load against the block deadline)
+    auto pQuality = std::make_unique<juce::AudioParameterChoice>("quality", "Quality", juce::StringArray { "Auto", "High", "Medium", "Low" }, 0);
+
+    // link group (instances in the same group share one detector, 0 = off)
+    auto pLinkGroup = std::make_unique<juce::AudioParameterInt>("link group", "Link Group", 0, LinkBus::numGroups, 0);
+
+    // dynamic eq band in the wet path (detects against threshold and ratio above, range is the deepest cut)
+    auto pDynEq = std::make_unique<juce::AudioParameterBool>("dyn eq", "Dynamic EQ", false);
+    auto pDynEqFreq = std::make_unique<juce::AudioParameterFloat>("dyn eq freq", "Dynamic EQ Frequency", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f), 3500.0f);
+    auto pDynEqQ = std::make_unique<juce::AudioParameterFloat>("dyn eq q", "Dynamic EQ Q", juce::NormalisableRange<float>(0.3f, 10.0f, 0.01f, 0.5f), 2.0f);
+    auto pDynEqRange = std::make_unique<juce::AudioParameterFloat>("dyn eq range", "Dynamic EQ Range", -24.0, 0.0, -6.0);
+
+    // auto release (fast and slow release around the release knob, blended by crest factor)
+    auto pAutoRelease = std::make_unique<juce::AudioParameterBool>("auto release", "Auto Release", false);
+
     params.push_back(std::move(pInputGain));
     params.push_back(std::move(pThreshold));
     params.push_back(std::move(pRatio));
@@ -82,42 +76,24 @@ juce::AudioProcessorValueTreeState::ParameterLayout ParallelCompressionAudioProc
     params.push_back(std::move(pOutputGain));
 
     params.push_back(std::move(pMixer));
-    return { params.begin(), params.end() };
 
-}
+    params.push_back(std::move(pStereoMode));
+    params.push_back(std::move(pSideThreshold));
+    params.push_back(std::move(pSideRatio));
+    params.push_back(std::move(pSideMixer));
 
-void ParallelCompressionAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
-{
-    if (parameterID == "input gain")
-    {
-        inputGain = newValue;
-    }
-    if (parameterID == "threshold")
-    {
-        threshold = juce::Decibels::decibelsToGain(newValue);
-    }
-    if (parameterID == "ratio")
-    {
-        ratio = newValue;
-    }
-    if (parameterID == "attack")
-    {
-        attack = calcAttack(newValue);
-    }
-    if (parameterID == "release")
-    {
-        release = calcRelease(newValue);
-    }
-    if (parameterID == "output gain")
-    {
-        outputGain = newValue;
-    }
-    if (parameterID == "mixer")
-    {
-        mixer = newValue;
-    }
-}
+    params.push_back(std::move(pQuality));
+    params.push_back(std::move(pLinkGroup));
+
+    params.push_back(std::move(pDynEq));
+    params.push_back(std::move(pDynEqFreq));
+    params.push_back(std::move(pDynEqQ));
+    params.push_back(std::move(pDynEqRange));
 
+    params.push_back(std::move(pAutoRelease));
+    return { params.begin(), params.end() };
+
+}
 
 //==============================================================================
 const juce::String ParallelCompressionAudioProcessor::getName() const
@@ -159,26 +135,45 @@ double ParallelCompressionAudioProcessor::getTailLengthSeconds() const
 
 int ParallelCompressionAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return presets.size();  // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                            // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int ParallelCompressionAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void ParallelCompressionAudioProcessor::setCurrentProgram (int index)
 {
+    if (! juce::isPositiveAndBelow(index, presets.size()))
+        return;
+
+    const auto& preset = presets[index];
+
+    // the audio thread stops reading the treestate until the whole preset is in it, and switches
+    // to the preset's precomputed settings as soon as the pointer below is published
+    ++programChangesInProgress;
+    pendingPreset = &preset;
+
+    for (auto& id : EngineParameters::getParameterIDs())
+    {
+        if (auto* parameter = treestate.getParameter(id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(preset.parameters.get(id)));
+    }
+
+    currentProgram = index;
+    --programChangesInProgress;
 }
 
 const juce::String ParallelCompressionAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return juce::isPositiveAndBelow(index, presets.size()) ? presets[index].name : juce::String();
 }
 
 void ParallelCompressionAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    juce::ignoreUnused (index, newName);
 }
 
 //==============================================================================
@@ -187,30 +182,47 @@ void ParallelCompressionAudioProcessor::prepareToPlay (double sampleRate, int sa
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
+    // some hosts re-prepare from another thread while blocks are still coming in,
+    // so swap the engine state under the same lock the wrappers hold around processBlock
+    const juce::ScopedLock lock(getCallbackLock());
+
     waveViewer.clear();
+    preparedSampleRate = sampleRate;
 
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumOutputChannels();
-    spec.sampleRate = sampleRate;
+    updateParameters();
+    engine.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
 
-    ingain.prepare(spec);
-    outgain.prepare(spec);
-    comp.prepare(spec);
-    mix.prepare(spec);
+    // the bank's coefficients are recalculated here rather than when a program is picked
+    presets.prepare(sampleRate, getTotalNumOutputChannels());
+    fadingEngine.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    fadeLength = juce::roundToInt(programFadeSeconds * sampleRate);
+    fadeRemaining = 0;
+    pendingPreset = nullptr;
 
-    ingain.reset();
-    outgain.reset();
-    comp.reset();
-    mix.reset();
+    governor.prepare(sampleRate);
+    blockLatency.reset();
+    analyzer.prepare(sampleRate);
 
-    updateParameters();
+   #if PARALLEL_COMPRESSION_TRACING
+    tracer.prepare(sampleRate);
+   #endif
+
+    memoryFootprintBytes = calcMemoryFootprintBytes();
+}
+
+size_t ParallelCompressionAudioProcessor::calcMemoryFootprintBytes() const
+{
+    return sizeof(*this) - sizeof(engine) - sizeof(fadingEngine) - sizeof(analyzer)
+         + engine.getMemoryFootprintBytes() + fadingEngine.getMemoryFootprintBytes()
+         + presets.getMemoryFootprintBytes() + analyzer.getMemoryFootprintBytes();
 }
 
 void ParallelCompressionAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    // the viewer is also written by processBlock, which may still be running on another thread
+    const juce::ScopedLock lock(getCallbackLock());
     waveViewer.clear();
 }
 
@@ -242,54 +254,207 @@ bool ParallelCompressionAudioProcessor::isBusesLayoutSupported (const BusesLayou
 
 void ParallelCompressionAudioProcessor::updateParameters()
 {
-    // connected input gain 
-   ingain.setGainDecibels(*treestate.getRawParameterValue("input gain"));
-   ingain.setRampDurationSeconds(0.25);
+   EngineParameters params;
 
-   // connected compressor parameters
-   comp.setThreshold(*treestate.getRawParameterValue("threshold"));
-   comp.setRatio(*treestate.getRawParameterValue("ratio"));
-   comp.setAttack(calcAttack(*treestate.getRawParameterValue("attack")));
-   comp.setRelease(calcRelease(*treestate.getRawParameterValue("release")));
+   // connected input and output gain
+   params.inputGain = *treestate.getRawParameterValue("input gain");
+   params.outputGain = *treestate.getRawParameterValue("output gain");
 
-   // connected output gain
-   outgain.setGainDecibels(*treestate.getRawParameterValue("output gain"));
-   outgain.setRampDurationSeconds(0.25);
+   // connected compressor parameters
+   params.threshold = *treestate.getRawParameterValue("threshold");
+   params.ratio = *treestate.getRawParameterValue("ratio");
+   params.attack = *treestate.getRawParameterValue("attack");
+   params.release = *treestate.getRawParameterValue("release");
+   params.autoRelease = *treestate.getRawParameterValue("auto release") >= 0.5f;
 
    // connected mix parameters
-   mix.setWetMixProportion(*treestate.getRawParameterValue("mixer") / 100);
+   params.mixer = *treestate.getRawParameterValue("mixer");
+
+   // connected stereo mode and side compressor parameters
+   params.stereoMode = static_cast<StereoMode>(static_cast<int>(*treestate.getRawParameterValue("stereo mode")));
+   params.sideThreshold = *treestate.getRawParameterValue("side threshold");
+   params.sideRatio = *treestate.getRawParameterValue("side ratio");
+   params.sideMixer = *treestate.getRawParameterValue("side mixer");
+
+   // connected dynamic eq band
+   params.dynamicEq = *treestate.getRawParameterValue("dyn eq") >= 0.5f;
+   params.dynamicEqFrequency = *treestate.getRawParameterValue("dyn eq freq");
+   params.dynamicEqQ = *treestate.getRawParameterValue("dyn eq q");
+   params.dynamicEqRange = *treestate.getRawParameterValue("dyn eq range");
+
+   // a stereo mode switch reroutes the compressors mid-signal, so it crossfades from the old mode
+   // (still running in fadingEngine) like a program change; one arriving mid-fade waits for the fade
+   if (params.stereoMode != engine.getParameters().stereoMode && fadeLength > 0)
+   {
+       if (fadeRemaining > 0)
+       {
+           params.stereoMode = engine.getParameters().stereoMode;
+       }
+       else
+       {
+           fadingEngine.copyStateFrom(engine);
+           fadeRemaining = fadeLength;
+       }
+   }
+
+   engine.setParameters(params);
+}
+
+void ParallelCompressionAudioProcessor::updateQuality(double elapsedSeconds, int numSamples)
+{
+    // the governor keeps measuring in every mode so the load meter always works
+    const auto measuredTier = governor.update(elapsedSeconds, numSamples);
+    const auto choice = static_cast<int>(*treestate.getRawParameterValue("quality"));
+
+    auto tier = choice == 0 ? measuredTier : static_cast<QualityTier>(choice - 1);
+
+    // offline renders have no deadline
+    if (isNonRealtime())
+        tier = QualityTier::high;
+
+    engine.setQualityTier(tier);
+    currentQualityTier = static_cast<int>(tier);
+    processingLoad = governor.getLoad();
+}
+
+void ParallelCompressionAudioProcessor::updateLinkGroup(int newGroup)
+{
+    if (newGroup == linkGroup)
+        return;
+
+    // join/leave are lock-free, so this is fine on the audio thread
+    auto& bus = LinkBus::getInstance();
+    bus.leave(linkGroup, linkSlot);
+
+    linkGroup = newGroup;
+    linkSlot = bus.join(linkGroup);
+
+    if (linkSlot < 0)
+        linkGroup = 0;  // group full, run unlinked
+}
+
+void ParallelCompressionAudioProcessor::startProgramFade(const PresetBank::Preset& preset)
+{
+    // the outgoing settings keep running, envelopes and all, for the length of the fade
+    fadingEngine.copyStateFrom(engine);
+
+    if (juce::exactlyEqual(preset.sampleRate, preparedSampleRate))
+        engine.applySettingsFrom(preset.engine);
+    else
+        engine.setParameters(preset.parameters); // the bank hasn't been prepared for this rate
+
+    fadeRemaining = fadeLength;
+}
+
+void ParallelCompressionAudioProcessor::processEngine(juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    const auto numSamples = buffer.getNumSamples();
+
+    if (fadeRemaining <= 0 || numChannels > ParallelCompressorEngine::maxChannels)
+    {
+        fadeRemaining = 0;  // a pending program change waits for this
+        engine.process(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+        return;
+    }
+
+    // run the old settings on a copy of the input in fadingEngine's scratch, then fade linearly from it
+    float* channels[ParallelCompressorEngine::maxChannels] = {};
+    float* fading[ParallelCompressorEngine::maxChannels] = {};
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto blockSize = juce::jmin(numSamples - start, fadingEngine.getScratchSize());
+
+        const auto fadingThisBlock = fadeRemaining > 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            channels[ch] = buffer.getWritePointer(ch, start);
+            fading[ch] = fadingEngine.getScratch(ch);
+
+            if (fadingThisBlock)
+                juce::FloatVectorOperations::copy(fading[ch], channels[ch], blockSize);
+        }
+
+        engine.process(channels, numChannels, blockSize);
+
+        if (fadingThisBlock)
+        {
+            fadingEngine.process(fading, numChannels, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const auto oldWeight = static_cast<float>(juce::jmax(0, fadeRemaining - i)) / static_cast<float>(fadeLength);
+                    channels[ch][i] += oldWeight * (fading[ch][i] - channels[ch][i]);
+                }
+            }
+
+            fadeRemaining -= blockSize;
+        }
+
+        start += blockSize;
+    }
 }
 
 void ParallelCompressionAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    juce::ignoreUnused (midiMessages);
     juce::ScopedNoDenormals noDenormals;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
     auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto totalNumOutputChannels = juce::jmin(getTotalNumOutputChannels(), buffer.getNumChannels());
+
+    PC_TRACE_BLOCK(tracer, buffer.getNumSamples());
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateParameters();
+    {
+        PC_TRACE_STAGE(tracer, StageTracer::updateParameters);
+
+        // a program change swaps in precomputed settings; while its parameter values are still
+        // being written to the treestate, the half-written set is left alone. A change arriving
+        // mid-fade waits for that fade to finish, since restarting it would drop the old settings
+        // mid-way and jump
+        const auto* preset = fadeRemaining <= 0 ? pendingPreset.exchange(nullptr) : nullptr;
+
+        if (preset != nullptr)
+            startProgramFade(*preset);
+        else if (pendingPreset.load() == nullptr && programChangesInProgress.load() == 0)
+            updateParameters();
+    }
+
+    // linked instances compress against the loudest detector among the rest of their group, ramping
+    // to it across the block; one that leaves its group ramps back to its own detector
+    updateLinkGroup(static_cast<int>(*treestate.getRawParameterValue("link group")));
+    engine.setLinkedLevel(linkGroup != 0 ? LinkBus::getInstance().read(linkGroup, linkSlot) : 0.0f, buffer.getNumSamples());
+
+    // both only copy into a fifo, and only while the editor is open
+    analyzer.push(SpectrumAnalyzer::dry, buffer);
+
+    // gains, compression and the dry/wet mix run fused in one pass
+    {
+        PC_TRACE_STAGE(tracer, StageTracer::engineProcess);
+        processEngine(buffer, totalNumOutputChannels);
+    }
+
+    if (linkGroup != 0)
+        LinkBus::getInstance().publish(linkGroup, linkSlot, engine.getDetectorLevel());
 
-    // audio block and context
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto context = juce::dsp::ProcessContextReplacing(block);
-
-    //instance of block before any processing to push dry signal into mixer
-    juce::dsp::AudioBlock<float>dryblock(buffer);  
-    dryblock = block;
-    mix.pushDrySamples(dryblock);
-    
-    // processing effects
-    ingain.process(context);
-    comp.process(context);
-    outgain.process(context);
-    
-    // now mixer has both wet and dry blocks of signal
-    mix.mixWetSamples(block);
+    analyzer.push(SpectrumAnalyzer::wet, buffer);
 
     // waveform viewer captures final result of signal
-    waveViewer.pushBuffer(buffer);
+    {
+        PC_TRACE_STAGE(tracer, StageTracer::waveViewer);
+        waveViewer.pushBuffer(buffer);
+    }
+
+    // picks the quality tier for the next block
+    const auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    updateQuality(elapsedSeconds, buffer.getNumSamples());
+    blockLatency.record(elapsedSeconds);
 }
 
 //==============================================================================
@@ -310,8 +475,9 @@ void ParallelCompressionAudioProcessor::getStateInformation (juce::MemoryBlock&
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
+    // copyState() takes the treestate's lock, so this is safe against a concurrent setStateInformation
     juce::MemoryOutputStream stream(destData, false);
-    treestate.state.writeToStream(stream);
+    treestate.copyState().writeToStream(stream);
 }
 
 void ParallelCompressionAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -320,17 +486,11 @@ void ParallelCompressionAudioProcessor::setStateInformation (const void* data, i
     // whose contents will have been created by the getStateInformation() call.
     auto tree = juce::ValueTree::readFromData(data, size_t(sizeInBytes));
 
-    if (tree.isValid())
+    if (tree.isValid() && tree.hasType(treestate.state.getType()))
     {
-        treestate.state = tree;
-        threshold = juce::Decibels::decibelsToGain(static_cast<float>(*treestate.getRawParameterValue("threshold")));
-        ratio = *treestate.getRawParameterValue("ratio");
-        attack = calcAttack(*treestate.getRawParameterValue("attack"));
-        release = calcRelease(*treestate.getRawParameterValue("release"));
-        
-        mixer = *treestate.getRawParameterValue("mixer");
-        inputGain = *treestate.getRawParameterValue("input gain");
-        outputGain = *treestate.getRawParameterValue("output gain");
+        // replaceState() swaps the tree under the treestate's lock and pushes the values into
+        // the parameter atomics the audio thread reads, so nothing else needs updating here
+        treestate.replaceState(tree);
     }
 }
 
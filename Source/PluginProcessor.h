@@ -9,11 +9,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+#include "StageTracer.h"
+#include "QualityGovernor.h"
+#include "LinkBus.h"
+#include "BlockLatencyStats.h"
+#include "SpectrumAnalyzer.h"
+#include "PresetBank.h"
 
 //==============================================================================
 /**
 */
-class ParallelCompressionAudioProcessor  : public juce::AudioProcessor, juce::AudioProcessorValueTreeState::Listener
+class ParallelCompressionAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -56,38 +63,73 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    // functions to calc attack and release times 
-    float calcAttack(float value);
-    float calcRelease(float value);
-
     void updateParameters();
 
+    // current engine quality tier and smoothed processBlock load (of the block deadline), for the editor and metering
+    QualityTier getQualityTier() const { return static_cast<QualityTier>(currentQualityTier.load()); }
+    float getProcessingLoad() const { return processingLoad.load(); }
+
+    // processBlock execution time (p99 / max) since the last prepareToPlay, readable from any thread
+    BlockLatencyStats::Summary getBlockLatency() const { return blockLatency.getSummary(); }
+
+    // this instance's DSP memory: the processor object, both engines' scratch arenas, the preset
+    // bank's prepared engines and the spectrum analyzer's FIFOs and tables (the treestate and wave
+    // viewer keep their own allocations), as of the last prepareToPlay; readable from any thread
+    size_t getMemoryFootprintBytes() const { return memoryFootprintBytes.load(); }
+
     // waveform visual - called in plugineditor
     juce::AudioVisualiserComponent waveViewer;
 
+    // dry vs. compressed spectrum - started and stopped by the editor
+    SpectrumAnalyzer analyzer;
+
     //==============================================================================
     // Value Trees
     juce::AudioProcessorValueTreeState treestate;
 
+   #if PARALLEL_COMPRESSION_TRACING
+    // per-stage timings of processBlock - drained by the editor
+    StageTracer tracer;
+   #endif
+
 private:
 
-    // effect objects
-    juce::dsp::Gain<float> ingain;
-    juce::dsp::Gain<float> outgain;
-    juce::dsp::Compressor<float> comp;
-    juce::dsp::DryWetMixer<float> mix;
-
-    // parameters
-    float inputGain = 1.0;
-    float threshold = 0.0;
-    float ratio = 3.0;
-    float attack = 3.0;
-    float release = 3.0;
-    float outputGain = 1.0;
-    float mixer = 100.0;
+    // effect chain (gains, compressors and dry/wet mix)
+    ParallelCompressorEngine engine;
+
+    // program changes: the host or editor thread picks a preset, the audio thread switches to its
+    // precomputed settings and fades from the old settings (still running in fadingEngine) to the new;
+    // stereo mode switches fade the same way
+    static constexpr double programFadeSeconds = 0.02;
+    PresetBank presets;
+    ParallelCompressorEngine fadingEngine;
+    std::atomic<const PresetBank::Preset*> pendingPreset { nullptr };
+    std::atomic<int> programChangesInProgress { 0 };
+    std::atomic<int> currentProgram { 0 };
+    int fadeLength = 0, fadeRemaining = 0;
+    double preparedSampleRate = 0.0;  // the host's getSampleRate() can change under a running block
+    void startProgramFade(const PresetBank::Preset& preset);
+    void processEngine(juce::AudioBuffer<float>& buffer, int numChannels);
+
+    // "auto" quality mode
+    QualityGovernor governor;
+    std::atomic<int> currentQualityTier { 0 };
+    std::atomic<float> processingLoad { 0.0f };
+    void updateQuality(double elapsedSeconds, int numSamples);
+
+    // processBlock timing histogram
+    BlockLatencyStats blockLatency;
+
+    // counted at the end of prepareToPlay, so the editor never reads the arenas while they're replaced
+    std::atomic<size_t> memoryFootprintBytes { 0 };
+    size_t calcMemoryFootprintBytes() const;
+
+    // slot held on the process-wide link bus (audio thread only)
+    int linkGroup = 0;
+    int linkSlot = -1;
+    void updateLinkGroup(int newGroup);
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelCompressionAudioProcessor)
 };
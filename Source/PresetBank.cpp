@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+//==============================================================================
+PresetBank::PresetBank()
+{
+    // the parameter defaults
+    add("Default", {});
+
+    {
+        EngineParameters p;
+        p.threshold = -30.0f;
+        p.ratio = 10.0f;
+        p.attack = 0.0f;
+        p.release = 2.0f;
+        p.outputGain = 6.0f;
+        p.mixer = 40.0f;
+        add("Drum Smash", p);
+    }
+
+    {
+        EngineParameters p;
+        p.threshold = -12.0f;
+        p.ratio = 2.0f;
+        p.attack = 6.0f;
+        p.release = 8.0f;
+        p.outputGain = 2.0f;
+        p.mixer = 50.0f;
+        add("Gentle Bus", p);
+    }
+
+    {
+        EngineParameters p;
+        p.threshold = -18.0f;
+        p.ratio = 3.0f;
+        p.attack = 4.0f;
+        p.release = 5.0f;
+        p.outputGain = 3.0f;
+        p.mixer = 60.0f;
+        p.dynamicEq = true;
+        p.dynamicEqFrequency = 3500.0f;
+        p.dynamicEqQ = 2.0f;
+        p.dynamicEqRange = -6.0f;
+        add("Vocal Glue", p);
+    }
+
+    {
+        EngineParameters p;
+        p.threshold = -24.0f;
+        p.ratio = 4.0f;
+        p.attack = 1.0f;
+        p.release = 3.0f;
+        p.dynamicEq = true;
+        p.dynamicEqFrequency = 3000.0f;
+        p.dynamicEqQ = 1.5f;
+        p.dynamicEqRange = -9.0f;
+        add("De-Harsh", p);
+    }
+
+    {
+        EngineParameters p;
+        p.stereoMode = StereoMode::midSide;
+        p.threshold = -20.0f;
+        p.ratio = 4.0f;
+        p.mixer = 40.0f;
+        p.sideThreshold = -28.0f;
+        p.sideRatio = 6.0f;
+        p.sideMixer = 70.0f;
+        p.outputGain = 3.0f;
+        add("M/S Density", p);
+    }
+}
+
+void PresetBank::add(const juce::String& name, const EngineParameters& parameters)
+{
+    auto preset = std::make_unique<Preset>();
+    preset->name = name;
+    preset->parameters = parameters;
+    presets.push_back(std::move(preset));
+}
+
+void PresetBank::prepare(double sampleRate, int numChannels)
+{
+    for (auto& preset : presets)
+    {
+        // prepare() snaps the gain and mix smoothers to the preset's values, and the
+        // scratch arena is only needed for processing, so keep it to one sample
+        preset->engine.setParameters(preset->parameters);
+        preset->engine.prepare(sampleRate, 1, numChannels);
+        preset->sampleRate = sampleRate;
+    }
+}
+
+size_t PresetBank::getMemoryFootprintBytes() const
+{
+    auto bytes = presets.capacity() * sizeof(presets[0]);
+
+    for (auto& preset : presets)
+        bytes += sizeof(*preset) - sizeof(preset->engine) + preset->engine.getMemoryFootprintBytes();
+
+    return bytes;
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    Factory presets for the host's program list. Each preset keeps an engine
+    prepared with its settings, so every coefficient it needs (ballistics,
+    gain curve, band filter, gains) is computed here, off the audio thread,
+    whenever the sample rate changes. Switching to a preset on the audio
+    thread is then just a copy of those settings.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        EngineParameters parameters;
+
+        // prepared with the parameters above at sampleRate (0 until the first prepare())
+        ParallelCompressorEngine engine;
+        double sampleRate = 0.0;
+    };
+
+    PresetBank();
+
+    // recomputes every preset's settings for this format; not for the audio thread
+    void prepare(double sampleRate, int numChannels);
+
+    int size() const { return static_cast<int>(presets.size()); }
+    const Preset& operator[](int index) const { return *presets[(size_t) index]; }
+
+    // heap held by the bank: the presets with their engines and scratch arenas
+    size_t getMemoryFootprintBytes() const;
+
+private:
+    void add(const juce::String& name, const EngineParameters& parameters);
+
+    std::vector<std::unique_ptr<Preset>> presets;
+
+    JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
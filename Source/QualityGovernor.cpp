@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.cpp
+
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+
+//==============================================================================
+void QualityGovernor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    load = 0.0;
+    overSeconds = 0.0;
+    underSeconds = 0.0;
+    tier = QualityTier::high;
+}
+
+QualityTier QualityGovernor::update(double elapsedSeconds, int numSamples)
+{
+    if (numSamples <= 0)
+        return tier;
+
+    const auto blockSeconds = numSamples / sampleRate;
+
+    // one-pole average over roughly 50ms of audio, independent of block size
+    const auto blockLoad = elapsedSeconds / blockSeconds;
+    const auto smoothing = std::exp(-blockSeconds / 0.05);
+    load = blockLoad + smoothing * (load - blockLoad);
+
+    overSeconds = load > stepDownLoad ? overSeconds + blockSeconds : 0.0;
+    underSeconds = load < stepUpLoad ? underSeconds + blockSeconds : 0.0;
+
+    if (overSeconds >= stepDownHoldSeconds && tier != QualityTier::low)
+    {
+        tier = static_cast<QualityTier>(static_cast<int>(tier) + 1);
+        overSeconds = 0.0;
+    }
+    else if (underSeconds >= stepUpHoldSeconds && tier != QualityTier::high)
+    {
+        tier = static_cast<QualityTier>(static_cast<int>(tier) - 1);
+        underSeconds = 0.0;
+    }
+
+    return tier;
+}
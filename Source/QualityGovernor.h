@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+
+    Picks the engine quality tier in "auto" mode. Each block's processing time
+    is compared with its deadline (numSamples / sampleRate); a sustained
+    overrun steps the tier down one level, and a long stretch of headroom
+    steps it back up. The two thresholds and hold times are far enough apart
+    that it doesn't flap between tiers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+class QualityGovernor
+{
+public:
+    void prepare(double sampleRate);
+
+    // feeds one block's processing time and returns the tier for the next block
+    QualityTier update(double elapsedSeconds, int numSamples);
+
+    // smoothed processing time as a proportion of the block deadline
+    float getLoad() const { return static_cast<float>(load); }
+
+private:
+    static constexpr double stepDownLoad = 0.7;
+    static constexpr double stepUpLoad = 0.3;
+    static constexpr double stepDownHoldSeconds = 0.1;
+    static constexpr double stepUpHoldSeconds = 3.0;
+
+    double sampleRate = 44100.0;
+    double load = 0.0;
+    double overSeconds = 0.0, underSeconds = 0.0;
+    QualityTier tier = QualityTier::high;
+};
@@ -0,0 +1,462 @@
+/*
+  ==============================================================================
+
+    RenderDaemon.cpp
+
+  ==============================================================================
+*/
+
+#include "RenderDaemon.h"
+#include "OfflineRenderer.h"
+
+#if ! JUCE_WINDOWS
+ #include <cerrno>
+ #include <sys/socket.h>
+ #include <sys/time.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+//==============================================================================
+RenderDaemon::RenderDaemon(const Options& o)
+    : options(o)
+{
+    options.numWorkers = options.numWorkers > 0 ? options.numWorkers : juce::SystemStats::getNumCpus();
+    options.maxQueuedJobs = juce::jmax(1, options.maxQueuedJobs);
+    options.blockSize = juce::jmax(1, options.blockSize);
+    options.requestTimeoutSeconds = juce::jmax(1, options.requestTimeoutSeconds);
+}
+
+RenderDaemon::~RenderDaemon()
+{
+    stop();
+}
+
+juce::Result RenderDaemon::start()
+{
+   #if JUCE_WINDOWS
+    return juce::Result::fail("The render daemon needs Unix domain sockets");
+   #else
+    if (running)
+        return juce::Result::ok();
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if (options.socketPath.getNumBytesAsUTF8() >= sizeof(address.sun_path))
+        return juce::Result::fail("Socket path is too long");
+
+    options.socketPath.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+    const auto listening = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listening < 0)
+        return juce::Result::fail("Couldn't create a socket");
+
+    ::unlink(options.socketPath.toRawUTF8());
+
+    if (::bind(listening, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listening, options.maxQueuedJobs) != 0)
+    {
+        ::close(listening);
+        return juce::Result::fail("Couldn't listen on " + options.socketPath);
+    }
+
+    listener = listening;
+
+    // warm the pool with one engine per worker for each common rate, mono and stereo; all of a
+    // format's engines are held until the last is prepared, or each would hand back the one before
+    for (auto sampleRate : options.warmSampleRates)
+    {
+        for (int numChannels = 1; numChannels <= ParallelCompressorEngine::maxChannels; ++numChannels)
+        {
+            std::vector<std::unique_ptr<ParallelCompressorEngine>> engines;
+
+            for (int i = 0; i < options.numWorkers; ++i)
+                engines.push_back(acquireEngine(sampleRate, numChannels));
+
+            for (auto& engine : engines)
+                releaseEngine(sampleRate, numChannels, std::move(engine));
+        }
+    }
+
+    running = true;
+
+    for (int i = 0; i < options.numWorkers; ++i)
+        workers.emplace_back([this] { workerLoop(); });
+
+    acceptThread = std::thread([this] { acceptLoop(); });
+    return juce::Result::ok();
+   #endif
+}
+
+void RenderDaemon::stop()
+{
+   #if ! JUCE_WINDOWS
+    if (! running.exchange(false))
+        return;
+
+    // unblocks accept() in the accept thread
+    const auto listening = listener.exchange(-1);
+    ::shutdown(listening, SHUT_RDWR);
+    ::close(listening);
+
+    {
+        // taking the lock orders the flag change before any waiter re-checks it
+        std::lock_guard<std::mutex> lock(queueLock);
+    }
+
+    jobAvailable.notify_all();
+    slotAvailable.notify_all();
+
+    acceptThread.join();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    workers.clear();
+
+    // anything still queued never ran
+    for (auto& job : queue)
+    {
+        writeLine(job.connection, "error daemon stopped");
+        ::close(job.connection);
+    }
+
+    queue.clear();
+    ::unlink(options.socketPath.toRawUTF8());
+   #endif
+}
+
+RenderDaemon::Statistics RenderDaemon::getStatistics() const
+{
+    Statistics stats;
+
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        stats.queueDepth = static_cast<int>(queue.size());
+        stats.running = numRunning;
+    }
+
+    std::vector<double> sorted;
+
+    {
+        std::lock_guard<std::mutex> lock(statsLock);
+        sorted = latencies;
+        stats.completed = numCompleted;
+        stats.failed = numFailed;
+    }
+
+    if (! sorted.empty())
+    {
+        std::sort(sorted.begin(), sorted.end());
+        stats.p50Ms = sorted[sorted.size() / 2];
+        stats.p99Ms = sorted[juce::jmin(sorted.size() - 1, sorted.size() * 99 / 100)];
+        stats.maxMs = sorted.back();
+    }
+
+    return stats;
+}
+
+//==============================================================================
+void RenderDaemon::acceptLoop()
+{
+   #if ! JUCE_WINDOWS
+    while (running)
+    {
+        const auto connection = ::accept(listener.load(), nullptr, nullptr);
+
+        if (connection < 0)
+        {
+            // a signal, or a client that hung up before it was accepted
+            if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+                continue;
+
+            // out of descriptors or memory: give the workers time to close some rather than spin
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(acceptRetryMs));
+                continue;
+            }
+
+            // anything else won't go away by retrying, and stop() closing the listener ends up here too
+            break;
+        }
+
+        // a client that connects and then says nothing would otherwise hold a worker forever
+        const timeval timeout { options.requestTimeoutSeconds, 0 };
+        ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        disableSigPipe(connection);
+
+        queueConnection(connection);
+    }
+   #endif
+}
+
+void RenderDaemon::queueConnection(int connection)
+{
+   #if ! JUCE_WINDOWS
+    Job job;
+    job.connection = connection;
+    job.submitted = juce::Time::getMillisecondCounterHiRes();
+
+    // back-pressure: stop accepting until a worker makes room in the queue
+    std::unique_lock<std::mutex> lock(queueLock);
+    slotAvailable.wait(lock, [this] { return ! running || static_cast<int>(queue.size()) < options.maxQueuedJobs; });
+
+    if (! running)
+    {
+        writeLine(connection, "error daemon stopped");
+        ::close(connection);
+        return;
+    }
+
+    queue.push_back(std::move(job));
+    jobAvailable.notify_one();
+   #else
+    juce::ignoreUnused(connection);
+   #endif
+}
+
+void RenderDaemon::workerLoop()
+{
+    for (;;)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(queueLock);
+            jobAvailable.wait(lock, [this] { return ! running || ! queue.empty(); });
+
+            if (! running)
+                return;
+
+            job = std::move(queue.front());
+            queue.pop_front();
+            ++numRunning;
+        }
+
+        slotAvailable.notify_one();
+        handleRequest(job);
+
+        std::lock_guard<std::mutex> lock(queueLock);
+        --numRunning;
+    }
+}
+
+void RenderDaemon::handleRequest(Job& job)
+{
+   #if ! JUCE_WINDOWS
+    const auto connection = job.connection;
+    const auto tokens = juce::StringArray::fromTokens(readLine(connection), "\t", "");
+
+    if (tokens[0] == "stats")
+    {
+        const auto stats = getStatistics();
+        writeLine(connection, "queued " + juce::String(stats.queueDepth)
+                            + " running " + juce::String(stats.running)
+                            + " completed " + juce::String(stats.completed)
+                            + " failed " + juce::String(stats.failed)
+                            + " p50 " + juce::String(stats.p50Ms, 2)
+                            + " p99 " + juce::String(stats.p99Ms, 2)
+                            + " max " + juce::String(stats.maxMs, 2));
+        ::close(connection);
+        return;
+    }
+
+    // also what a client that timed out gets
+    if (tokens[0] != "render" || tokens.size() < 3)
+    {
+        writeLine(connection, "error bad request");
+        ::close(connection);
+        return;
+    }
+
+    job.input = juce::File::getCurrentWorkingDirectory().getChildFile(tokens[1]);
+    job.output = juce::File::getCurrentWorkingDirectory().getChildFile(tokens[2]);
+
+    for (int i = 3; i < tokens.size(); ++i)
+    {
+        const auto parameterID = tokens[i].upToFirstOccurrenceOf("=", false, false);
+        const auto value = tokens[i].fromFirstOccurrenceOf("=", false, false).getFloatValue();
+
+        if (! job.parameters.set(parameterID, value))
+        {
+            writeLine(connection, "error unknown parameter " + parameterID);
+            ::close(connection);
+            return;
+        }
+    }
+
+    runJob(job);
+   #else
+    juce::ignoreUnused(job);
+   #endif
+}
+
+void RenderDaemon::runJob(Job& job)
+{
+    auto result = juce::Result::fail("Couldn't open " + job.input.getFullPathName());
+
+    // only the header is read here, the renderer maps the audio itself
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> info(wav.createMemoryMappedReader(job.input));
+
+    if (info != nullptr)
+    {
+        const auto sampleRate = info->sampleRate;
+        const auto numChannels = static_cast<int>(info->numChannels);
+        info.reset();
+
+        if (numChannels >= 1 && numChannels <= ParallelCompressorEngine::maxChannels)
+        {
+            auto engine = acquireEngine(sampleRate, numChannels);
+
+            // reset drops the previous job's envelopes and starts the ramps at the new settings
+            engine->setParameters(job.parameters);
+            engine->reset();
+
+            result = OfflineRenderer::renderSerial(job.input, job.output, *engine, options.blockSize);
+            releaseEngine(sampleRate, numChannels, std::move(engine));
+        }
+        else
+        {
+            result = juce::Result::fail("Only mono and stereo files can be rendered");
+        }
+    }
+
+    const auto latency = juce::Time::getMillisecondCounterHiRes() - job.submitted;
+    recordLatency(latency, result.wasOk());
+
+    writeLine(job.connection, result.wasOk() ? "ok " + juce::String(latency, 2)
+                                             : "error " + result.getErrorMessage());
+   #if ! JUCE_WINDOWS
+    ::close(job.connection);
+   #endif
+}
+
+//==============================================================================
+std::unique_ptr<ParallelCompressorEngine> RenderDaemon::acquireEngine(double sampleRate, int numChannels)
+{
+    {
+        std::lock_guard<std::mutex> lock(poolLock);
+        auto& engines = pool[{ sampleRate, numChannels }];
+
+        if (! engines.empty())
+        {
+            auto engine = std::move(engines.back());
+            engines.pop_back();
+            return engine;
+        }
+    }
+
+    // uncommon formats are prepared on first use and kept warm from then on
+    auto engine = std::make_unique<ParallelCompressorEngine>();
+    engine->prepare(sampleRate, options.blockSize, numChannels);
+    return engine;
+}
+
+void RenderDaemon::releaseEngine(double sampleRate, int numChannels, std::unique_ptr<ParallelCompressorEngine> engine)
+{
+    std::lock_guard<std::mutex> lock(poolLock);
+    pool[{ sampleRate, numChannels }].push_back(std::move(engine));
+}
+
+void RenderDaemon::recordLatency(double milliseconds, bool succeeded)
+{
+    std::lock_guard<std::mutex> lock(statsLock);
+
+    if (latencies.size() < latencyHistory)
+        latencies.push_back(milliseconds);
+    else
+        latencies[nextLatency] = milliseconds;
+
+    nextLatency = (nextLatency + 1) % latencyHistory;
+    ++(succeeded ? numCompleted : numFailed);
+}
+
+//==============================================================================
+juce::String RenderDaemon::readLine(int connection)
+{
+    juce::MemoryOutputStream line;
+
+   #if ! JUCE_WINDOWS
+    char c = 0;
+
+    while (line.getDataSize() < 65536 && ::read(connection, &c, 1) == 1 && c != '\n')
+        line.writeByte(c);
+   #else
+    juce::ignoreUnused(connection);
+   #endif
+
+    return line.toUTF8();
+}
+
+void RenderDaemon::writeLine(int connection, const juce::String& line)
+{
+   #if ! JUCE_WINDOWS
+    const auto text = line + "\n";
+    const auto* data = text.toRawUTF8();
+    auto remaining = text.getNumBytesAsUTF8();
+
+   #ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;  // a client that hung up must not kill the daemon
+   #else
+    const int flags = 0;
+   #endif
+
+    while (remaining > 0)
+    {
+        const auto sent = ::send(connection, data, remaining, flags);
+
+        if (sent <= 0)
+            break;
+
+        data += sent;
+        remaining -= static_cast<size_t>(sent);
+    }
+   #else
+    juce::ignoreUnused(connection, line);
+   #endif
+}
+
+void RenderDaemon::disableSigPipe(int connection)
+{
+    // macOS has no MSG_NOSIGNAL, so a peer that hung up must not raise SIGPIPE on a write there either
+   #if JUCE_MAC
+    const int noSigPipe = 1;
+    ::setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+   #else
+    juce::ignoreUnused(connection);
+   #endif
+}
+
+juce::String RenderDaemon::sendRequest(const juce::String& socketPath, const juce::String& request)
+{
+   #if JUCE_WINDOWS
+    juce::ignoreUnused(socketPath, request);
+    return "error the render daemon needs Unix domain sockets";
+   #else
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    socketPath.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+    const auto connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (connection < 0)
+        return "error couldn't create a socket";
+
+    if (::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        ::close(connection);
+        return "error couldn't connect to " + socketPath;
+    }
+
+    disableSigPipe(connection);
+
+    writeLine(connection, request);
+    const auto reply = readLine(connection);
+    ::close(connection);
+    return reply;
+   #endif
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    RenderDaemon.h
+
+    Long-running render service. Keeps engines prepared for the common sample
+    rates and layouts so a job only pays for its DSP, takes jobs over a Unix
+    domain socket and runs them on a fixed set of worker threads. The accept
+    thread only queues connections; a worker reads the request, so a slow
+    client can't hold up the others. The queue is bounded: when it is full the
+    daemon stops accepting connections until a worker frees a slot, which
+    pushes back on the clients.
+
+    Protocol, one tab-separated line per connection:
+        render <input path> <output path> [<parameter id>=<value> ...]
+            -> "ok <latency ms>" or "error <message>" once the job has finished
+        stats
+            -> "queued <n> running <n> completed <n> failed <n> p50 <ms> p99 <ms> max <ms>"
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParallelCompressorEngine.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+//==============================================================================
+class RenderDaemon
+{
+public:
+    struct Options
+    {
+        juce::String socketPath = "/tmp/parallel-compression.sock";
+        int numWorkers = 0;             // 0 = one per core
+        int maxQueuedJobs = 64;
+        int blockSize = 512;
+        int requestTimeoutSeconds = 10; // how long a worker waits for a client's request line
+        juce::Array<double> warmSampleRates { 44100.0, 48000.0, 88200.0, 96000.0 };
+    };
+
+    struct Statistics
+    {
+        int queueDepth = 0;
+        int running = 0;
+        juce::int64 completed = 0;
+        juce::int64 failed = 0;
+        double p50Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;   // submit to finish, over recent jobs
+    };
+
+    explicit RenderDaemon(const Options& options);
+    ~RenderDaemon();
+
+    // binds the socket and starts the workers
+    juce::Result start();
+    void stop();
+
+    Statistics getStatistics() const;
+
+    //==============================================================================
+    // stand-in client: sends one request line and waits for the reply
+    static juce::String sendRequest(const juce::String& socketPath, const juce::String& request);
+
+private:
+    struct Job
+    {
+        int connection = -1;
+        double submitted = 0.0;     // ms, from juce::Time::getMillisecondCounterHiRes()
+
+        // filled in from the request line by the worker
+        juce::File input, output;
+        EngineParameters parameters;
+    };
+
+    void acceptLoop();
+    void workerLoop();
+    void queueConnection(int connection);
+    void handleRequest(Job& job);
+    void runJob(Job& job);
+
+    // engine pool keyed by sample rate and channel count
+    std::unique_ptr<ParallelCompressorEngine> acquireEngine(double sampleRate, int numChannels);
+    void releaseEngine(double sampleRate, int numChannels, std::unique_ptr<ParallelCompressorEngine> engine);
+
+    void recordLatency(double milliseconds, bool succeeded);
+
+    static juce::String readLine(int connection);
+    static void writeLine(int connection, const juce::String& line);
+    static void disableSigPipe(int connection);
+
+    Options options;
+    std::atomic<int> listener { -1 };   // closed by stop() while the accept thread may be using it
+    std::atomic<bool> running { false };
+
+    std::thread acceptThread;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex queueLock;
+    std::condition_variable jobAvailable, slotAvailable;
+    std::deque<Job> queue;
+    int numRunning = 0;
+
+    std::mutex poolLock;
+    std::map<std::pair<double, int>, std::vector<std::unique_ptr<ParallelCompressorEngine>>> pool;
+
+    mutable std::mutex statsLock;
+    std::vector<double> latencies;      // ring of recent job latencies
+    size_t nextLatency = 0;
+    juce::int64 numCompleted = 0, numFailed = 0;
+
+    static constexpr size_t latencyHistory = 1024;
+
+    // how long the accept thread waits before retrying when it runs out of descriptors or memory
+    static constexpr int acceptRetryMs = 100;
+
+    JUCE_DECLARE_NON_COPYABLE(RenderDaemon)
+};
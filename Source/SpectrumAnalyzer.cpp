@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : juce::Thread("Spectrum Analyzer")
+{
+    for (auto& signalLevels : levels)
+        for (auto& level : signalLevels)
+            level = floorDb;
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+}
+
+void SpectrumAnalyzer::prepare(double sampleRate)
+{
+    // the analysis thread rebuilds its tables when it sees the change
+    currentSampleRate = sampleRate;
+}
+
+void SpectrumAnalyzer::start()
+{
+    if (isThreadRunning())
+        return;
+
+    // whatever was left over from the last time the editor was open is stale; the analysis thread
+    // isn't reading and the audio thread stopped pushing with it, so both FIFOs empty together
+    for (auto& queue : queues)
+        queue.fifo.finishedRead(queue.fifo.getNumReady());
+
+    active = true;
+    startThread();
+}
+
+void SpectrumAnalyzer::stop()
+{
+    active = false;
+    stopThread(1000);
+}
+
+void SpectrumAnalyzer::push(Signal signal, const juce::AudioBuffer<float>& buffer) noexcept
+{
+    const auto numChannels = buffer.getNumChannels();
+    auto numToPush = 0;
+
+    if (signal == dry)
+    {
+        // if the analysis thread falls behind, the dry block only takes what both FIFOs have room
+        // for; it only ever frees space, so the wet block that follows is sure to fit as much
+        if (active.load(std::memory_order_relaxed) && numChannels > 0)
+            numToPush = juce::jmin(buffer.getNumSamples(), queues[dry].fifo.getFreeSpace(), queues[wet].fifo.getFreeSpace());
+
+        pendingWetSamples = numToPush;
+    }
+    else
+    {
+        // follows the dry push even if the analyzer stopped in between, to keep the pair whole
+        numToPush = juce::jmin(pendingWetSamples, buffer.getNumSamples());
+        pendingWetSamples = 0;
+    }
+
+    if (numToPush <= 0 || numChannels == 0)
+        return;
+
+    auto& queue = queues[(size_t) signal];
+    const auto scale = 1.0f / static_cast<float>(numChannels);
+    const auto scope = queue.fifo.write(numToPush);
+
+    auto copy = [&](int destStart, int numToCopy, int sourceStart)
+    {
+        if (numToCopy <= 0)
+            return;
+
+        auto* dest = queue.samples.data() + destStart;
+        juce::FloatVectorOperations::copyWithMultiply(dest, buffer.getReadPointer(0, sourceStart), scale, numToCopy);
+
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::addWithMultiply(dest, buffer.getReadPointer(ch, sourceStart), scale, numToCopy);
+    };
+
+    copy(scope.startIndex1, scope.blockSize1, 0);
+    copy(scope.startIndex2, scope.blockSize2, scope.blockSize1);
+}
+
+size_t SpectrumAnalyzer::getMemoryFootprintBytes() const noexcept
+{
+    auto bytes = sizeof(*this);
+
+    for (auto& queue : queues)
+        bytes += queue.samples.capacity() * sizeof(float);
+
+    // juce::dsp::FFT keeps its engine private; this is the fallback engine's twiddle table,
+    // and the window holds one coefficient per sample
+    return bytes + (size_t) fftSize * sizeof(std::complex<float>) + (size_t) fftSize * sizeof(float);
+}
+
+float SpectrumAnalyzer::getBandFrequency(int band) noexcept
+{
+    return minFrequency * std::pow(maxFrequency / minFrequency, (static_cast<float>(band) + 0.5f) / numBands);
+}
+
+//==============================================================================
+void SpectrumAnalyzer::run()
+{
+    for (auto& signalHistory : history)
+        signalHistory.fill(0.0f);
+
+    while (! threadShouldExit())
+    {
+        const auto sampleRate = currentSampleRate.load();
+
+        if (! juce::exactlyEqual(sampleRate, tableSampleRate))
+            updateBandTable(sampleRate);
+
+        // dry and wet are pushed together, so they're analysed in step
+        if (queues[dry].fifo.getNumReady() < hopSize || queues[wet].fifo.getNumReady() < hopSize)
+        {
+            wait(10);
+            continue;
+        }
+
+        for (int signal = 0; signal < numSignals; ++signal)
+            analyse(signal);
+    }
+}
+
+void SpectrumAnalyzer::analyse(int signal)
+{
+    auto& queue = queues[(size_t) signal];
+    auto& signalHistory = history[(size_t) signal];
+
+    // slide the frame along by one hop (50% overlap)
+    std::copy(signalHistory.begin() + hopSize, signalHistory.end(), signalHistory.begin());
+
+    {
+        const auto scope = queue.fifo.read(hopSize);
+        auto* dest = signalHistory.data() + (fftSize - hopSize);
+
+        std::copy_n(queue.samples.data() + scope.startIndex1, scope.blockSize1, dest);
+        std::copy_n(queue.samples.data() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+    }
+
+    std::copy(signalHistory.begin(), signalHistory.end(), fftData.begin());
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    // a full-scale sine reads 0 dB (a Hann window has a coherent gain of 0.5)
+    constexpr auto magnitudeScale = 4.0f / static_cast<float>(fftSize);
+    auto& signalLevels = levels[(size_t) signal];
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto first = bandEdges[(size_t) band];
+        const auto last = juce::jmax(first + 1, bandEdges[(size_t) band + 1]);
+
+        auto magnitude = 0.0f;
+
+        for (int bin = first; bin < last; ++bin)
+            magnitude = juce::jmax(magnitude, fftData[(size_t) bin]);
+
+        // rises immediately, falls at a fixed rate
+        const auto db = juce::Decibels::gainToDecibels(magnitude * magnitudeScale, floorDb);
+        const auto previous = signalLevels[(size_t) band].load(std::memory_order_relaxed);
+        signalLevels[(size_t) band].store(juce::jmax(db, previous - decayPerHop), std::memory_order_relaxed);
+    }
+}
+
+void SpectrumAnalyzer::updateBandTable(double sampleRate)
+{
+    // FFT bin at the lower edge of each log-spaced band, clamped below nyquist
+    for (int band = 0; band <= numBands; ++band)
+    {
+        const auto frequency = minFrequency * std::pow(maxFrequency / minFrequency, static_cast<float>(band) / numBands);
+        bandEdges[(size_t) band] = juce::jlimit(1, fftSize / 2, juce::roundToInt(frequency * fftSize / sampleRate));
+    }
+
+    // 30 dB per second
+    decayPerHop = static_cast<float>(30.0 * hopSize / sampleRate);
+    tableSampleRate = sampleRate;
+}
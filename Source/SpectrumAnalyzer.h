@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Dry vs. compressed spectrum for the editor. While it's running, the audio
+    thread only copies a mono sum of each signal into a lock-free FIFO; the
+    windowing, FFT, log-frequency binning and smoothing all happen on the
+    analyzer's own thread, and the editor reads the finished bands. When the
+    editor closes the thread stops and the audio thread stops copying.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+    static constexpr int numBands = 96;
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+    static constexpr float floorDb = -100.0f;
+
+    enum Signal
+    {
+        dry = 0,
+        wet,
+        numSignals
+    };
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    void prepare(double sampleRate);
+
+    // message thread: start and stop the analysis (the editor's lifetime)
+    void start();
+    void stop();
+
+    // audio thread: copies the block into the signal's FIFO if the analyzer is running. Call it
+    // with the dry block and then the wet one: the pair goes in whole or not at all, so the two
+    // FIFOs always hold the same stretch of audio
+    void push(Signal signal, const juce::AudioBuffer<float>& buffer) noexcept;
+
+    // any thread: smoothed level of a band in dB, and the band's centre frequency
+    float getBandLevel(Signal signal, int band) const noexcept { return levels[(size_t) signal][(size_t) band].load(std::memory_order_relaxed); }
+    static float getBandFrequency(int band) noexcept;
+
+    // bytes this analyzer owns: the object itself, its FIFOs, and the FFT's and window's tables
+    size_t getMemoryFootprintBytes() const noexcept;
+
+private:
+    void run() override;
+    void analyse(int signal);
+    void updateBandTable(double sampleRate);
+
+    std::atomic<bool> active { false };
+    std::atomic<double> currentSampleRate { 44100.0 };
+
+    // audio thread -> analysis thread
+    struct Queue
+    {
+        juce::AbstractFifo fifo { fftSize * 8 };
+        std::vector<float> samples = std::vector<float>((size_t) fftSize * 8);
+    };
+
+    std::array<Queue, numSignals> queues;
+    int pendingWetSamples = 0;  // audio thread only: how much of the wet block the dry push made room for
+
+    // analysis thread only (tables are built up front and again only when the sample rate changes)
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::array<std::array<float, fftSize>, numSignals> history {};
+    std::array<float, fftSize * 2> fftData {};
+    std::array<int, numBands + 1> bandEdges {};     // first FFT bin of each band, plus one past the last
+    double tableSampleRate = 0.0;
+    float decayPerHop = 0.0f;                       // dB the display falls per hop when the level drops
+
+    // analysis thread -> editor
+    std::array<std::array<std::atomic<float>, numBands>, numSignals> levels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
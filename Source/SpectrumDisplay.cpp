@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyzer& a)
+    : analyzer(a)
+{
+    analyzer.start();
+    startTimerHz(30);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    stopTimer();
+
+    // nothing is analysed (or copied on the audio thread) while the editor is closed
+    analyzer.stop();
+}
+
+void SpectrumDisplay::timerCallback()
+{
+    repaint();
+}
+
+juce::Path SpectrumDisplay::createCurve(SpectrumAnalyzer::Signal signal) const
+{
+    const auto bounds = getLocalBounds().reduced(4).toFloat();
+    juce::Path curve;
+
+    for (int band = 0; band < SpectrumAnalyzer::numBands; ++band)
+    {
+        // bands are log-spaced, so they sit evenly across the width
+        const auto x = bounds.getX() + bounds.getWidth() * (static_cast<float>(band) + 0.5f) / SpectrumAnalyzer::numBands;
+        const auto y = juce::jmap(analyzer.getBandLevel(signal, band), SpectrumAnalyzer::floorDb, 0.0f, bounds.getBottom(), bounds.getY());
+
+        if (band == 0)
+            curve.startNewSubPath(x, y);
+        else
+            curve.lineTo(x, y);
+    }
+
+    return curve;
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    const auto bounds = getLocalBounds().reduced(4).toFloat();
+
+    // grid at 100 Hz, 1 kHz and 10 kHz
+    g.setColour(juce::Colours::whitesmoke.withAlpha(0.15f));
+    g.setFont(11.0f);
+
+    for (auto frequency : { 100.0f, 1000.0f, 10000.0f })
+    {
+        const auto proportion = std::log(frequency / SpectrumAnalyzer::minFrequency)
+                                / std::log(SpectrumAnalyzer::maxFrequency / SpectrumAnalyzer::minFrequency);
+        const auto x = bounds.getX() + bounds.getWidth() * proportion;
+
+        g.drawVerticalLine(juce::roundToInt(x), bounds.getY(), bounds.getBottom());
+        g.drawText(frequency >= 1000.0f ? juce::String(frequency / 1000.0f, 0) + "k" : juce::String(frequency, 0),
+                   juce::Rectangle<float>(x + 2.0f, bounds.getY(), 40.0f, 14.0f), juce::Justification::centredLeft);
+    }
+
+    // dry underneath, compressed on top
+    g.setColour(juce::Colours::whitesmoke.withAlpha(0.35f));
+    g.strokePath(createCurve(SpectrumAnalyzer::dry), juce::PathStrokeType(1.0f));
+
+    g.setColour(juce::Colours::orange);
+    g.strokePath(createCurve(SpectrumAnalyzer::wet), juce::PathStrokeType(1.5f));
+}
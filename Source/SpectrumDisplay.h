@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+
+    Editor view for SpectrumAnalyzer: the dry and the compressed spectrum
+    drawn over each other on a log frequency axis. The analyzer runs for as
+    long as this component exists.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+class SpectrumDisplay : public juce::Component, private juce::Timer
+{
+public:
+    explicit SpectrumDisplay(SpectrumAnalyzer& analyzer);
+    ~SpectrumDisplay() override;
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    void timerCallback() override;
+    juce::Path createCurve(SpectrumAnalyzer::Signal signal) const;
+
+    SpectrumAnalyzer& analyzer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
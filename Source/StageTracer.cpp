@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    StageTracer.cpp
+
+  ==============================================================================
+*/
+
+#include "StageTracer.h"
+
+//==============================================================================
+const char* StageTracer::getStageName(int stage)
+{
+    switch (stage)
+    {
+        case processBlock:      return "processBlock";
+        case updateParameters:  return "updateParameters";
+        case engineProcess:     return "engine.process";
+        case waveViewer:        return "waveViewer.pushBuffer";
+        default:                return "unknown";
+    }
+}
+
+StageTracer::StageTracer()
+    : ring((size_t) ringSize)
+{
+}
+
+void StageTracer::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    referenceCycles = readCycleCounter();
+    referenceMs = juce::Time::getMillisecondCounterHiRes();
+}
+
+void StageTracer::record(int stage, juce::uint64 start, juce::uint64 end) noexcept
+{
+    // wait-free: if the ring is full the event is dropped
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        ring[(size_t) scope.startIndex1] = { start, end, stage, currentBlockSize };
+    else if (scope.blockSize2 > 0)
+        ring[(size_t) scope.startIndex2] = { start, end, stage, currentBlockSize };
+}
+
+//==============================================================================
+double StageTracer::getCyclesPerMicrosecond() const
+{
+    // calibrated against the wall clock since prepare, so no busy-wait is needed
+    const auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - referenceMs.load();
+    const auto elapsedCycles = static_cast<double>(readCycleCounter() - referenceCycles.load());
+
+    return elapsedMs > 1.0 ? elapsedCycles / (elapsedMs * 1000.0) : 1000.0;
+}
+
+std::array<StageTracer::StageStats, StageTracer::numStages> StageTracer::drain()
+{
+    std::array<StageStats, numStages> stats;
+    std::array<int, numStages> counts {};
+
+    const auto cyclesPerMicrosecond = getCyclesPerMicrosecond();
+    const auto microsecondsPerSample = 1.0e6 / sampleRate.load();
+
+    const auto scope = fifo.read(fifo.getNumReady());
+
+    auto collect = [&](int startIndex, int blockSize)
+    {
+        for (int i = startIndex; i < startIndex + blockSize; ++i)
+        {
+            const auto& event = ring[(size_t) i];
+
+            if (event.numSamples > 0 && juce::isPositiveAndBelow(event.stage, (int) numStages))
+            {
+                const auto durationUs = static_cast<double>(event.end - event.start) / cyclesPerMicrosecond;
+                const auto percent = 100.0 * durationUs / (event.numSamples * microsecondsPerSample);
+
+                auto& stage = stats[(size_t) event.stage];
+                stage.averagePercent += percent;
+                stage.peakPercent = juce::jmax(stage.peakPercent, percent);
+                ++counts[(size_t) event.stage];
+            }
+
+            if (history.size() < maxHistory)
+                history.push_back(event);
+        }
+    };
+
+    collect(scope.startIndex1, scope.blockSize1);
+    collect(scope.startIndex2, scope.blockSize2);
+
+    for (size_t i = 0; i < stats.size(); ++i)
+        if (counts[i] > 0)
+            stats[i].averagePercent /= counts[i];
+
+    return stats;
+}
+
+juce::Result StageTracer::exportChromeTrace(const juce::File& file)
+{
+    drain();
+
+    const auto cyclesPerMicrosecond = getCyclesPerMicrosecond();
+    const auto origin = history.empty() ? juce::uint64() : history.front().start;
+
+    juce::FileOutputStream out(file);
+
+    if (! out.openedOk())
+        return juce::Result::fail("Couldn't write " + file.getFullPathName());
+
+    out.setPosition(0);
+    out.truncate();
+
+    // complete ("X") events on one track, timestamps in microseconds
+    out << "{\"traceEvents\":[\n";
+
+    for (size_t i = 0; i < history.size(); ++i)
+    {
+        const auto& event = history[i];
+        const auto ts = static_cast<double>(event.start - origin) / cyclesPerMicrosecond;
+        const auto dur = static_cast<double>(event.end - event.start) / cyclesPerMicrosecond;
+
+        out << "{\"name\":\"" << getStageName(event.stage) << "\",\"cat\":\"audio\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+            << "\"ts\":" << juce::String(ts, 3) << ",\"dur\":" << juce::String(dur, 3)
+            << ",\"args\":{\"samples\":" << event.numSamples << "}}"
+            << (i + 1 < history.size() ? ",\n" : "\n");
+    }
+
+    out << "],\"displayTimeUnit\":\"ns\"}\n";
+    out.flush();
+
+    history.clear();
+    return out.getStatus();
+}
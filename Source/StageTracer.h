@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    StageTracer.h
+
+    Optional hot-path tracing for processBlock. Build with
+    PARALLEL_COMPRESSION_TRACING=1 to time each stage with the CPU cycle
+    counter. The audio thread only writes fixed-size events into a ring that
+    is allocated up front (and drops events if nobody drains it); draining,
+    statistics and the Chrome trace / Perfetto JSON export happen elsewhere.
+    With tracing off the macros compile to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef PARALLEL_COMPRESSION_TRACING
+ #define PARALLEL_COMPRESSION_TRACING 0
+#endif
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+class StageTracer
+{
+public:
+    enum Stage
+    {
+        processBlock = 0,
+        updateParameters,
+        engineProcess,      // gains, compressor and mixer (fused)
+        waveViewer,
+        numStages
+    };
+
+    static const char* getStageName(int stage);
+
+    struct Event
+    {
+        juce::uint64 start = 0, end = 0;    // cycle counter
+        int stage = 0;
+        int numSamples = 0;                 // size of the block the event belongs to
+    };
+
+    StageTracer();
+
+    // stores the sample rate for deadlines and a reference point for converting cycles to time
+    void prepare(double sampleRate);
+
+    //==============================================================================
+    // audio thread
+    void beginBlock(int numSamples) noexcept { currentBlockSize = numSamples; }
+    void record(int stage, juce::uint64 start, juce::uint64 end) noexcept;
+
+    static inline juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return static_cast<juce::uint64>(__rdtsc());
+       #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+        juce::uint64 value;
+        asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+        return value;
+       #else
+        return static_cast<juce::uint64>(juce::Time::getHighResolutionTicks());
+       #endif
+    }
+
+    struct ScopedTimer
+    {
+        ScopedTimer(StageTracer& t, int s) noexcept : tracer(t), stage(s), start(readCycleCounter()) {}
+        ~ScopedTimer() noexcept { tracer.record(stage, start, readCycleCounter()); }
+
+        StageTracer& tracer;
+        const int stage;
+        const juce::uint64 start;
+    };
+
+    //==============================================================================
+    // any other (single) thread
+    struct StageStats
+    {
+        double averagePercent = 0.0;    // of the block deadline
+        double peakPercent = 0.0;
+    };
+
+    // moves new events out of the ring into the history and returns per-stage stats for them
+    std::array<StageStats, numStages> drain();
+
+    // writes the drained history as Chrome trace / Perfetto JSON
+    juce::Result exportChromeTrace(const juce::File& file);
+
+private:
+    double getCyclesPerMicrosecond() const;
+
+    static constexpr int ringSize = 4096;
+    static constexpr size_t maxHistory = 200000;
+
+    juce::AbstractFifo fifo { ringSize };
+    std::vector<Event> ring;
+    int currentBlockSize = 0;
+
+    std::atomic<double> sampleRate { 44100.0 };
+    std::atomic<juce::uint64> referenceCycles { 0 };
+    std::atomic<double> referenceMs { 0.0 };
+
+    std::vector<Event> history;
+
+    JUCE_DECLARE_NON_COPYABLE(StageTracer)
+};
+
+#if PARALLEL_COMPRESSION_TRACING
+ #define PC_TRACE_BLOCK(tracer, numSamples)  (tracer).beginBlock(numSamples); \
+                                             StageTracer::ScopedTimer JUCE_JOIN_MACRO(stageTimer, __LINE__) (tracer, StageTracer::processBlock)
+ #define PC_TRACE_STAGE(tracer, stage)       StageTracer::ScopedTimer JUCE_JOIN_MACRO(stageTimer, __LINE__) (tracer, stage)
+#else
+ #define PC_TRACE_BLOCK(tracer, numSamples)
+ #define PC_TRACE_STAGE(tracer, stage)
+#endif
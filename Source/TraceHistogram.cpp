@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    TraceHistogram.cpp
+
+  ==============================================================================
+*/
+
+#include "TraceHistogram.h"
+
+//==============================================================================
+TraceHistogram::TraceHistogram(StageTracer& t)
+    : tracer(t)
+{
+    startTimerHz(4);
+}
+
+TraceHistogram::~TraceHistogram()
+{
+    stopTimer();
+}
+
+void TraceHistogram::timerCallback()
+{
+    // draining happens here on the message thread, never on the audio thread
+    stats = tracer.drain();
+    repaint();
+}
+
+void TraceHistogram::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    auto bounds = getLocalBounds().reduced(4);
+    const auto rowHeight = bounds.getHeight() / static_cast<int>(StageTracer::numStages);
+
+    g.setFont(11.0f);
+
+    for (int stage = 0; stage < StageTracer::numStages; ++stage)
+    {
+        auto row = bounds.removeFromTop(rowHeight).reduced(0, 1);
+        auto label = row.removeFromLeft(row.getWidth() / 2);
+        const auto& s = stats[(size_t) stage];
+
+        // bar is the average, tick is the peak, full width is the whole deadline
+        const auto averageWidth = juce::jlimit(0.0, 1.0, s.averagePercent / 100.0) * row.getWidth();
+        const auto peakX = row.getX() + juce::jlimit(0.0, 1.0, s.peakPercent / 100.0) * row.getWidth();
+
+        g.setColour(juce::Colours::whitesmoke.withAlpha(0.15f));
+        g.fillRect(row);
+        g.setColour(s.peakPercent > 75.0 ? juce::Colours::orangered : juce::Colours::whitesmoke.withAlpha(0.6f));
+        g.fillRect(row.withWidth(juce::roundToInt(averageWidth)));
+        g.drawVerticalLine(juce::roundToInt(peakX), (float) row.getY(), (float) row.getBottom());
+
+        g.setColour(juce::Colours::whitesmoke);
+        g.drawFittedText(juce::String(StageTracer::getStageName(stage)) + " " + juce::String(s.averagePercent, 1) + "%",
+                         label, juce::Justification::centredLeft, 1);
+    }
+}
+
+void TraceHistogram::mouseUp(const juce::MouseEvent&)
+{
+    chooser = std::make_unique<juce::FileChooser>("Export trace", juce::File(), "*.json");
+    chooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
+                         [this](const juce::FileChooser& fc)
+    {
+        const auto file = fc.getResult();
+
+        if (file != juce::File())
+            tracer.exportChromeTrace(file.withFileExtension("json"));
+    });
+}
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    TraceHistogram.h
+
+    Editor view for StageTracer: one bar per processBlock stage showing its
+    average and peak cost as a percentage of the block deadline. Click to
+    export the collected trace as Chrome trace / Perfetto JSON.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StageTracer.h"
+
+//==============================================================================
+class TraceHistogram : public juce::Component, private juce::Timer
+{
+public:
+    explicit TraceHistogram(StageTracer& tracer);
+    ~TraceHistogram() override;
+
+    void paint(juce::Graphics& g) override;
+    void mouseUp(const juce::MouseEvent& event) override;
+
+private:
+    void timerCallback() override;
+
+    StageTracer& tracer;
+    std::array<StageTracer::StageStats, StageTracer::numStages> stats {};
+    std::unique_ptr<juce::FileChooser> chooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceHistogram)
+};
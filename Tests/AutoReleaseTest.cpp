@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    AutoReleaseTest.cpp
+
+    Auto release against the fixed release it's built around: short bursts
+    should recover faster, dense material slower.
+
+  ==============================================================================
+*/
+
+#include "ParallelCompressorEngine.h"
+
+//==============================================================================
+class AutoReleaseTest : public juce::UnitTest
+{
+public:
+    AutoReleaseTest() : juce::UnitTest("Auto release", "Engine") {}
+
+    void runTest() override
+    {
+        beginTest("Transients recover faster than the fixed release");
+        {
+            const auto fixed = measureRecoveryMs<false>(Material::transients);
+            const auto automatic = measureRecoveryMs<true>(Material::transients);
+            logMessage("2ms bursts: fixed " + juce::String(fixed, 1) + " ms, auto " + juce::String(automatic, 1) + " ms");
+
+            expectLessThan(automatic, 0.75 * fixed);
+        }
+
+        beginTest("Sustained material recovers slower than the fixed release");
+        {
+            const auto fixed = measureRecoveryMs<false>(Material::sustained);
+            const auto automatic = measureRecoveryMs<true>(Material::sustained);
+            logMessage("steady tone: fixed " + juce::String(fixed, 1) + " ms, auto " + juce::String(automatic, 1) + " ms");
+
+            expectGreaterThan(automatic, 2.0 * fixed);
+        }
+
+        beginTest("The engine switches release kernels with the parameter");
+        {
+            EngineParameters parameters;
+            parameters.threshold = thresholdDb;
+            parameters.ratio = ratio;
+
+            for (int tier = 0; tier < numQualityTiers; ++tier)
+            {
+                const auto fixed = renderThroughEngine(parameters, static_cast<QualityTier>(tier));
+
+                parameters.autoRelease = true;
+                const auto automatic = renderThroughEngine(parameters, static_cast<QualityTier>(tier));
+                parameters.autoRelease = false;
+
+                // the sustained tone releases slower with auto release, so the quiet tail stays more compressed
+                expectLessThan(automatic, fixed * 0.9f);
+            }
+        }
+    }
+
+private:
+    enum class Material
+    {
+        transients,
+        sustained
+    };
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr float thresholdDb = -30.0f, ratio = 4.0f, attackMs = 5.0f, releaseMs = 150.0f;
+    static constexpr int materialLength = 24000, burstLength = 96, burstPeriod = 4800;
+
+    // the transients are bursts every 100ms, the last one ending where the material stops
+    static float generate(Material material, int i)
+    {
+        const auto tone = std::sin(0.13f * static_cast<float>(i));
+
+        if (material == Material::sustained)
+            return 0.5f * tone;
+
+        return (i % burstPeriod) < burstLength ? 0.9f * tone : 0.0f;
+    }
+
+    // ms until the gain is back within 1 dB of unity once the material stops
+    template <bool AutoRelease>
+    static double measureRecoveryMs(Material material)
+    {
+        CompressorCore core;
+        core.prepare(sampleRate);
+        core.setThreshold(thresholdDb);
+        core.setRatio(ratio);
+        core.setAttack(attackMs);
+        core.setRelease(releaseMs);
+        core.setAutoRelease(AutoRelease);
+
+        for (int i = 0; i < materialLength + burstLength; ++i)
+            core.processGain<AutoRelease>(0, generate(material, i));
+
+        const auto withinOneDb = juce::Decibels::decibelsToGain(-1.0f);
+
+        for (int i = 0; i < static_cast<int>(sampleRate); ++i)
+            if (core.processGain<AutoRelease>(0, 0.001f * std::sin(0.13f * static_cast<float>(i))) > withinOneDb)
+                return i * 1000.0 / sampleRate;
+
+        return 1000.0;
+    }
+
+    // gain 100ms after the sustained tone drops by 40 dB (the peak over the last 10ms against the input's)
+    static float renderThroughEngine(const EngineParameters& parameters, QualityTier tier)
+    {
+        constexpr int numSamples = materialLength + 4800;
+
+        ParallelCompressorEngine engine;
+        engine.setParameters(parameters);
+        engine.prepare(sampleRate, numSamples, 1);
+        engine.setQualityTier(tier);
+
+        std::vector<float> signal((size_t) numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            signal[(size_t) i] = generate(Material::sustained, i) * (i < materialLength ? 1.0f : 0.01f);
+
+        auto* channels = signal.data();
+        engine.process(&channels, 1, numSamples);
+
+        auto peak = 0.0f;
+
+        for (int i = numSamples - 480; i < numSamples; ++i)
+            peak = juce::jmax(peak, std::abs(signal[(size_t) i]));
+
+        return peak / 0.005f;
+    }
+};
+
+static AutoReleaseTest autoReleaseTest;
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    AutomationLanesTest.cpp
+
+    Parsing of automation files, and the values, breakpoints and control-rate
+    events a render reads from the lanes: holds, steps and linear ramps.
+
+  ==============================================================================
+*/
+
+#include "AutomationLanes.h"
+
+//==============================================================================
+class AutomationLanesTest : public juce::UnitTest
+{
+public:
+    AutomationLanesTest() : juce::UnitTest("Automation lanes", "Renderer") {}
+
+    void runTest() override
+    {
+        beginTest("Parsing");
+        {
+            AutomationLanes lanes;
+            expect(lanes.parse(R"({ "threshold": [ [0.0, -12.0] ] })").wasOk());
+            expect(! lanes.isEmpty());
+
+            expect(lanes.parse("[ [0.0, 1.0] ]").failed(), "not an object");
+            expect(lanes.parse(R"({ "thresh": [ [0.0, -12.0] ] })").failed(), "unknown parameter");
+            expect(lanes.parse(R"({ "threshold": [] })").failed(), "empty lane");
+            expect(lanes.parse(R"({ "threshold": [ [0.0] ] })").failed(), "breakpoint without a value");
+            expect(lanes.parse(R"({ "threshold": [ 0.0, -12.0 ] })").failed(), "breakpoint not an array");
+            expect(lanes.parse("{ threshold").failed(), "malformed JSON");
+
+            // a failed parse leaves the lanes it had
+            expect(! lanes.isEmpty());
+        }
+
+        // at 1 kHz a breakpoint's sample is its time in milliseconds
+        AutomationLanes lanes;
+        expect(lanes.parse(R"({
+                                  "threshold": [ [2.0, -24.0], [1.0, -12.0] ],
+                                  "mixer":     [ [0.5, 100.0], [0.5, 40.0] ],
+                                  "ratio":     [ [0.0, 4.0], [1.0, 4.0] ]
+                              })").wasOk());
+        lanes.prepare(1000.0);
+
+        beginTest("Holds, steps and ramps");
+        {
+            const auto threshold = [&](juce::int64 position) { return getValue(lanes, position).threshold; };
+            const auto mixer = [&](juce::int64 position) { return getValue(lanes, position).mixer; };
+
+            // breakpoints are sorted by time, and a lane holds its first and last values outside them
+            expectWithinAbsoluteError(threshold(0), -12.0f, 0.0f);
+            expectWithinAbsoluteError(threshold(1000), -12.0f, 0.0f);
+            expectWithinAbsoluteError(threshold(2000), -24.0f, 0.0f);
+            expectWithinAbsoluteError(threshold(100000), -24.0f, 0.0f);
+
+            // linear in between
+            expectWithinAbsoluteError(threshold(1250), -15.0f, 1.0e-4f);
+            expectWithinAbsoluteError(threshold(1500), -18.0f, 1.0e-4f);
+
+            // two breakpoints at one time step on that sample
+            expectWithinAbsoluteError(mixer(499), 100.0f, 0.0f);
+            expectWithinAbsoluteError(mixer(500), 40.0f, 0.0f);
+
+            expectWithinAbsoluteError(getValue(lanes, 700).ratio, 4.0f, 0.0f);
+            expectWithinAbsoluteError(getValue(lanes, 700).release, EngineParameters().release, 0.0f, "unautomated parameters are left alone");
+        }
+
+        beginTest("Breakpoints and control-rate events");
+        {
+            const auto never = std::numeric_limits<juce::int64>::max();
+
+            expectEquals(lanes.getNextBreakpoint(0), (juce::int64) 500);
+            expectEquals(lanes.getNextBreakpoint(500), (juce::int64) 1000);
+            expectEquals(lanes.getNextBreakpoint(1000), (juce::int64) 2000);
+            expectEquals(lanes.getNextBreakpoint(2000), never);
+
+            // a lane between equal values holds rather than ramps
+            expect(! lanes.isRamping(700));
+            expect(lanes.isRamping(1000));
+            expect(lanes.isRamping(1999));
+            expect(! lanes.isRamping(2000));
+
+            // while ramping, events fall on the control-rate grid and on breakpoints, never in between
+            constexpr auto interval = AutomationLanes::controlInterval;
+            expectEquals(lanes.getNextEvent(700), (juce::int64) 1000);
+            expectEquals(lanes.getNextEvent(1000), (juce::int64) (1000 / interval + 1) * interval);
+            expectEquals(lanes.getNextEvent(1010), (juce::int64) (1010 / interval + 1) * interval);
+            expectEquals(lanes.getNextEvent(1999), (juce::int64) 2000);
+            expectEquals(lanes.getNextEvent(2000), never);
+        }
+    }
+
+private:
+    static EngineParameters getValue(const AutomationLanes& lanes, juce::int64 position)
+    {
+        EngineParameters parameters;
+        lanes.apply(position, parameters);
+        return parameters;
+    }
+};
+
+static AutomationLanesTest automationLanesTest;
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    BlockSizeInvarianceTest.cpp
+
+    Every kernel path (channels, stereo mode, dynamic EQ, auto release) is
+    rendered from the reference signal at every block size from 1 to 4096
+    and with random sizes, at every quality tier, and compared with the
+    one-sample render; then against golden renders kept in Tests/Golden.
+
+    After an intentional change to the DSP, run with PC_UPDATE_GOLDEN=1 in
+    the environment to rewrite the golden files instead of comparing.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+class BlockSizeInvarianceTest : public juce::UnitTest
+{
+public:
+    BlockSizeInvarianceTest() : juce::UnitTest("Block size invariance", "Engine") {}
+
+    void runTest() override
+    {
+        const auto goldenDir = juce::File(PC_GOLDEN_DIR);
+        const auto updating = juce::SystemStats::getEnvironmentVariable("PC_UPDATE_GOLDEN", {}).isNotEmpty();
+        const auto referenceFile = goldenDir.getChildFile("Reference signal.wav");
+
+        beginTest("Reference signal");
+
+        auto input = OfflineRenderer::createReferenceSignal(sampleRate, 2);
+
+        if (updating)
+        {
+            expect(writeWav(referenceFile, input), "couldn't write " + referenceFile.getFullPathName());
+        }
+        else
+        {
+            // the renders below start from the stored copy, so a change to the generator shows up here on its own
+            const auto stored = readWav(referenceFile);
+            expect(stored.getNumSamples() > 0, "missing " + referenceFile.getFullPathName());
+            expectLessOrEqual(measureErrorDb(input, stored), -120.0, "reference signal differs from its golden copy");
+            input.makeCopyOf(stored);
+        }
+
+        for (const auto& path : paths)
+        {
+            beginTest(path.name);
+
+            auto parameters = getParameters();
+            parameters.stereoMode = path.stereoMode;
+            parameters.dynamicEq = path.dynamicEq;
+            parameters.autoRelease = path.autoRelease;
+
+            juce::AudioBuffer<float> pathInput(path.numChannels, input.getNumSamples());
+
+            for (int ch = 0; ch < path.numChannels; ++ch)
+                pathInput.copyFrom(ch, 0, input, ch, 0, input.getNumSamples());
+
+            OfflineRenderer::InvarianceReport report;
+            const auto result = OfflineRenderer::checkBlockSizeInvariance(pathInput, sampleRate, parameters, invarianceToleranceDb,
+                                                                          &report, maxBlockSize, numRandomRenders);
+            expect(result.wasOk(), result.getErrorMessage());
+
+            for (int tier = 0; tier < numQualityTiers; ++tier)
+            {
+                auto line = juce::String(path.name) + ", " + tierNames[tier] + ": block sizes "
+                          + formatDb(report.tierMaxErrorDb[(size_t) tier]) + " (limit " + formatDb(invarianceToleranceDb) + ")";
+
+                if (path.goldenToleranceDb[tier] < 0.0f)
+                {
+                    const auto rendered = render(pathInput, parameters, static_cast<QualityTier>(tier));
+                    const auto goldenFile = goldenDir.getChildFile(juce::String(path.name) + " " + tierNames[tier] + ".wav");
+
+                    if (updating)
+                    {
+                        expect(writeWav(goldenFile, rendered), "couldn't write " + goldenFile.getFullPathName());
+                        line << ", golden rewritten";
+                    }
+                    else
+                    {
+                        const auto golden = readWav(goldenFile);
+                        expect(golden.getNumSamples() > 0, "missing " + goldenFile.getFullPathName());
+
+                        const auto errorDb = measureErrorDb(rendered, golden);
+                        expectLessOrEqual(errorDb, static_cast<double>(path.goldenToleranceDb[tier]),
+                                          line + ": differs from " + goldenFile.getFileName());
+
+                        line << ", golden " << formatDb(errorDb) << " (limit " << formatDb(path.goldenToleranceDb[tier]) << ")";
+                    }
+                }
+
+                logMessage(line);
+            }
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 16000.0;
+    static constexpr int maxBlockSize = 4096;
+    static constexpr int numRandomRenders = 16;
+
+    // every kernel carries all of its state across blocks, so renders at different block sizes
+    // should be bit-identical; this leaves room for nothing more than rounding
+    static constexpr float invarianceToleranceDb = -140.0f;
+
+    static constexpr const char* tierNames[numQualityTiers] = { "high", "medium", "low" };
+
+    struct RenderPath
+    {
+        const char* name;   // also names the golden files
+        int numChannels;
+        StereoMode stereoMode;
+        bool dynamicEq, autoRelease;
+
+        // allowed deviation from the golden render at each tier (dBFS), 0 = no golden file at that tier;
+        // the goldens may come from another compiler or libm, so these allow for rounding that builds up
+        // through the envelopes (and the band's filter), and for auto release a crest step landing a sample
+        // earlier or later. Renders at reduced quality hold the rounding for a whole control interval.
+        float goldenToleranceDb[numQualityTiers];
+    };
+
+    static constexpr RenderPath paths[] =
+    {
+        { "LR mono",                1, StereoMode::leftRight, false, false, { -110.0f,    0.0f,    0.0f } },
+        { "LR",                     2, StereoMode::leftRight, false, false, { -110.0f, -105.0f, -100.0f } },
+        { "MS",                     2, StereoMode::midSide,   false, false, { -110.0f,    0.0f,    0.0f } },
+        { "M only",                 2, StereoMode::midOnly,   false, false, { -110.0f,    0.0f,    0.0f } },
+        { "S only",                 2, StereoMode::sideOnly,  false, false, { -110.0f,    0.0f,    0.0f } },
+        { "LR dyn eq",              2, StereoMode::leftRight, true,  false, { -100.0f,    0.0f,    0.0f } },
+        { "MS dyn eq",              2, StereoMode::midSide,   true,  false, { -100.0f,    0.0f,    0.0f } },
+        { "LR auto release",        2, StereoMode::leftRight, false, true,  {  -90.0f,    0.0f,    0.0f } },
+        { "MS dyn eq auto release", 2, StereoMode::midSide,   true,  true,  {  -90.0f,  -90.0f,  -90.0f } }
+    };
+
+    // settings that keep every stage working on the reference signal
+    static EngineParameters getParameters()
+    {
+        EngineParameters parameters;
+        parameters.inputGain = 2.0f;
+        parameters.threshold = -24.0f;
+        parameters.ratio = 4.0f;
+        parameters.attack = 1.0f;
+        parameters.release = 3.0f;
+        parameters.outputGain = 3.0f;
+        parameters.mixer = 70.0f;
+        parameters.sideThreshold = -30.0f;
+        parameters.sideRatio = 6.0f;
+        parameters.sideMixer = 80.0f;
+        parameters.dynamicEqFrequency = 3000.0f;
+        parameters.dynamicEqQ = 2.0f;
+        parameters.dynamicEqRange = -9.0f;
+        return parameters;
+    }
+
+    static juce::AudioBuffer<float> render(const juce::AudioBuffer<float>& input, const EngineParameters& parameters, QualityTier tier)
+    {
+        auto output = input;
+
+        ParallelCompressorEngine engine;
+        engine.setParameters(parameters);
+        engine.prepare(sampleRate, output.getNumSamples(), output.getNumChannels());
+        engine.setQualityTier(tier);
+        engine.process(output.getArrayOfWritePointers(), output.getNumChannels(), output.getNumSamples());
+
+        return output;
+    }
+
+    // worst sample difference in dBFS, or +inf if the layouts don't match
+    static double measureErrorDb(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+            return std::numeric_limits<double>::infinity();
+
+        auto maxError = 0.0f;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                maxError = juce::jmax(maxError, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+
+        return maxError > 0.0f ? 20.0 * std::log10(static_cast<double>(maxError)) : -std::numeric_limits<double>::infinity();
+    }
+
+    static juce::String formatDb(double db)
+    {
+        return std::isinf(db) ? juce::String(db < 0.0 ? "-inf dBFS" : "mismatch") : juce::String(db, 1) + " dBFS";
+    }
+
+    static juce::AudioBuffer<float> readWav(const juce::File& file)
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader(wav.createReaderFor(file.createInputStream().release(), true));
+
+        if (reader == nullptr)
+            return {};
+
+        juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+        reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        return buffer;
+    }
+
+    static bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& buffer)
+    {
+        file.deleteFile();
+
+        juce::WavAudioFormat wav;
+        auto stream = file.createOutputStream();
+
+        if (stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(buffer.getNumChannels()),
+                                                                            32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release(); // now owned by the writer
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+};
+
+static BlockSizeInvarianceTest blockSizeInvarianceTest;
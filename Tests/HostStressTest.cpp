@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    HostStressTest.cpp
+
+    A hostile host: blocks of random size (0 and 1 included) on an audio
+    thread while other threads re-prepare at new sample rates, switch between
+    mono and stereo, move parameters, change programs and get and set the
+    state, all at once. Build with PC_SANITIZE_THREAD=ON to run it under
+    ThreadSanitizer.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+
+#include <thread>
+
+//==============================================================================
+class HostStressTest : public juce::UnitTest
+{
+public:
+    HostStressTest() : juce::UnitTest("Hostile host", "Processor") {}
+
+    void runTest() override
+    {
+        beginTest("Processing while re-preparing, changing layout, parameters, programs and state");
+
+        ParallelCompressionAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(48000.0, 512);
+        processor.prepareToPlay(48000.0, 512);
+
+        std::atomic<bool> running { true };
+        std::atomic<juce::int64> numBlocks { 0 };
+        std::atomic<int> numNonFiniteBlocks { 0 };
+        std::atomic<int> numRejectedLayouts { 0 };
+        BlockLatencyStats latency;
+
+        std::vector<std::thread> threads;
+
+        // audio thread, holding the callback lock around processBlock like the plugin wrappers do
+        threads.emplace_back([&]
+        {
+            juce::Random random(1);
+            juce::AudioBuffer<float> buffer(2, maxBlockSize);
+            juce::MidiBuffer midi;
+
+            while (running)
+            {
+                const auto numSamples = pickBlockSize(random);
+
+                {
+                    const juce::ScopedLock lock(processor.getCallbackLock());
+
+                    if (! processor.isSuspended())
+                    {
+                        const auto numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+                        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+                        for (int ch = 0; ch < numChannels; ++ch)
+                            for (int i = 0; i < numSamples; ++i)
+                                block.setSample(ch, i, 2.0f * random.nextFloat() - 1.0f);
+
+                        const auto start = juce::Time::getHighResolutionTicks();
+                        processor.processBlock(block, midi);
+                        latency.record(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+
+                        if (! isFinite(block))
+                            ++numNonFiniteBlocks;
+
+                        ++numBlocks;
+                    }
+                }
+
+                std::this_thread::yield();
+            }
+        });
+
+        // host thread: new sample rates and block sizes without stopping the audio thread, and
+        // mono/stereo switches and releaseResources() with processing suspended, as wrappers do
+        threads.emplace_back([&]
+        {
+            juce::Random random(2);
+            const double sampleRates[] = { 22050.0, 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+
+            while (running)
+            {
+                const auto sampleRate = sampleRates[random.nextInt(juce::numElementsInArray(sampleRates))];
+                const auto blockSize = 1 << random.nextInt({ 0, 12 });
+
+                if (random.nextInt(4) == 0)
+                {
+                    const auto channelSet = random.nextBool() ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
+
+                    juce::AudioProcessor::BusesLayout layout;
+                    layout.inputBuses.add(channelSet);
+                    layout.outputBuses.add(channelSet);
+
+                    processor.suspendProcessing(true);
+                    processor.releaseResources();
+
+                    if (! processor.setBusesLayout(layout))
+                        ++numRejectedLayouts;
+
+                    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                    processor.prepareToPlay(sampleRate, blockSize);
+                    processor.suspendProcessing(false);
+                }
+                else
+                {
+                    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                    processor.prepareToPlay(sampleRate, blockSize);
+                }
+
+                juce::Thread::sleep(random.nextInt({ 1, 10 }));
+            }
+        });
+
+        // automation on every parameter, the per-instance ones included
+        threads.emplace_back([&]
+        {
+            juce::Random random(3);
+            const auto& parameters = processor.getParameters();
+
+            while (running)
+            {
+                parameters[random.nextInt(parameters.size())]->setValueNotifyingHost(random.nextFloat());
+                std::this_thread::yield();
+            }
+        });
+
+        // program changes
+        threads.emplace_back([&]
+        {
+            juce::Random random(4);
+
+            while (running)
+            {
+                processor.setCurrentProgram(random.nextInt(processor.getNumPrograms()));
+                juce::Thread::sleep(random.nextInt({ 0, 5 }));
+            }
+        });
+
+        // two threads saving and restoring the state, each restoring what the other saved
+        std::array<juce::MemoryBlock, 2> savedStates;
+        std::array<juce::CriticalSection, 2> savedStateLocks;
+
+        for (int i = 0; i < 2; ++i)
+        {
+            threads.emplace_back([&, i]
+            {
+                while (running)
+                {
+                    juce::MemoryBlock state;
+                    processor.getStateInformation(state);
+
+                    {
+                        const juce::ScopedLock lock(savedStateLocks[(size_t) i]);
+                        savedStates[(size_t) i] = state;
+                    }
+
+                    {
+                        const juce::ScopedLock lock(savedStateLocks[(size_t) (1 - i)]);
+                        state = savedStates[(size_t) (1 - i)];
+                    }
+
+                    if (state.getSize() > 0)
+                        processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        juce::Thread::sleep(runMilliseconds);
+        running = false;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        const auto summary = latency.getSummary();
+        logMessage("processBlock over " + juce::String(summary.numBlocks) + " blocks: p99 " + juce::String(summary.p99Microseconds, 1)
+                   + " us, max " + juce::String(summary.maxMicroseconds, 1) + " us");
+
+        expect(numBlocks > 0, "no blocks were processed");
+        expectEquals(numNonFiniteBlocks.load(), 0, "blocks with NaN or inf in the output");
+        expectEquals(numRejectedLayouts.load(), 0, "mono or stereo layouts rejected");
+    }
+
+private:
+    static constexpr int maxBlockSize = 8192;
+    static constexpr int runMilliseconds = 3000;
+
+    // mostly ordinary sizes, with empty, single-sample and oversized blocks thrown in
+    static int pickBlockSize(juce::Random& random)
+    {
+        switch (random.nextInt(8))
+        {
+            case 0:  return 0;
+            case 1:  return 1;
+            case 2:  return random.nextInt({ maxBlockSize / 2, maxBlockSize + 1 });
+            default: return random.nextInt({ 2, 1025 });
+        }
+    }
+
+    static bool isFinite(const juce::AudioBuffer<float>& block)
+    {
+        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+            for (int i = 0; i < block.getNumSamples(); ++i)
+                if (! std::isfinite(block.getSample(ch, i)))
+                    return false;
+
+        return true;
+    }
+};
+
+static HostStressTest hostStressTest;
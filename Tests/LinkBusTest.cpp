@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    LinkBusTest.cpp
+
+    Slots joining and leaving a link group, members going stale, reads
+    leaving out the reader's own slot, and engines linked through the bus:
+    a group of one has to run exactly like an unlinked instance, and a new
+    linked level ramps in across the block instead of stepping.
+
+  ==============================================================================
+*/
+
+#include "LinkBus.h"
+#include "ParallelCompressorEngine.h"
+
+#include <set>
+
+//==============================================================================
+class LinkBusTest : public juce::UnitTest
+{
+public:
+    LinkBusTest() : juce::UnitTest("Link bus", "Engine") {}
+
+    void runTest() override
+    {
+        auto& bus = LinkBus::getInstance();
+
+        beginTest("Join and leave");
+        {
+            expectEquals(bus.join(0), -1, "group 0 means unlinked");
+            expectEquals(bus.join(LinkBus::numGroups + 1), -1);
+
+            std::vector<int> slots;
+
+            for (int i = 0; i < LinkBus::slotsPerGroup; ++i)
+                slots.push_back(bus.join(testGroup));
+
+            expect(std::find(slots.begin(), slots.end(), -1) == slots.end(), "couldn't fill the group");
+            expectEquals(static_cast<int>(std::set<int>(slots.begin(), slots.end()).size()), LinkBus::slotsPerGroup, "slots handed out twice");
+            expectEquals(bus.join(testGroup), -1, "the group is full");
+
+            // a slot that's left is free for the next member, and starts out silent
+            bus.publish(testGroup, slots[3], 0.5f);
+            bus.leave(testGroup, slots[3]);
+            expectEquals(bus.join(testGroup), slots[3]);
+            expectWithinAbsoluteError(bus.read(testGroup), 0.0f, 0.0f);
+
+            for (auto slot : slots)
+                bus.leave(testGroup, slot);
+        }
+
+        beginTest("Reads leave out the reader");
+        {
+            const auto a = bus.join(testGroup);
+            const auto b = bus.join(testGroup);
+            const auto silent = bus.join(testGroup);
+
+            bus.publish(testGroup, a, 0.5f);
+            bus.publish(testGroup, b, 0.25f);
+
+            expectWithinAbsoluteError(bus.read(testGroup), 0.5f, 0.0f);
+            expectWithinAbsoluteError(bus.read(testGroup, a), 0.25f, 0.0f);
+            expectWithinAbsoluteError(bus.read(testGroup, b), 0.5f, 0.0f);
+            expectWithinAbsoluteError(bus.read(testGroup, silent), 0.5f, 0.0f, "a member that hasn't published yet");
+            expectWithinAbsoluteError(bus.read(otherGroup), 0.0f, 0.0f, "groups are separate");
+
+            bus.leave(testGroup, b);
+            expectWithinAbsoluteError(bus.read(testGroup, a), 0.0f, 0.0f, "the only other member left");
+
+            bus.leave(testGroup, a);
+            bus.leave(testGroup, silent);
+        }
+
+        beginTest("Stale members drop out");
+        {
+            const auto live = bus.join(testGroup);
+            const auto stale = bus.join(testGroup);
+
+            bus.publish(testGroup, stale, 0.5f);
+            juce::Thread::sleep(static_cast<int>(LinkBus::staleMs) + 50);
+            bus.publish(testGroup, live, 0.25f);
+
+            expectWithinAbsoluteError(bus.read(testGroup), 0.25f, 0.0f);
+
+            // and come back with their next block
+            bus.publish(testGroup, stale, 0.5f);
+            expectWithinAbsoluteError(bus.read(testGroup), 0.5f, 0.0f);
+
+            bus.leave(testGroup, live);
+            bus.leave(testGroup, stale);
+        }
+
+        beginTest("A group of one runs like an unlinked instance");
+        {
+            ParallelCompressorEngine linked, unlinked;
+            prepareEngine(linked);
+            prepareEngine(unlinked);
+
+            const auto slot = bus.join(testGroup);
+            juce::Random random(1);
+            auto maxError = 0.0f;
+
+            for (int block = 0; block < 200; ++block)
+            {
+                const auto numSamples = 1 + random.nextInt(blockSize);
+                juce::AudioBuffer<float> linkedBlock(2, numSamples), unlinkedBlock(2, numSamples);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < numSamples; ++i)
+                        linkedBlock.setSample(ch, i, 0.5f * (2.0f * random.nextFloat() - 1.0f));
+
+                unlinkedBlock.makeCopyOf(linkedBlock);
+
+                // as the processor runs a block
+                linked.setLinkedLevel(bus.read(testGroup, slot), numSamples);
+                linked.process(linkedBlock.getArrayOfWritePointers(), 2, numSamples);
+                bus.publish(testGroup, slot, linked.getDetectorLevel());
+
+                unlinked.process(unlinkedBlock.getArrayOfWritePointers(), 2, numSamples);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < numSamples; ++i)
+                        maxError = juce::jmax(maxError, std::abs(linkedBlock.getSample(ch, i) - unlinkedBlock.getSample(ch, i)));
+            }
+
+            expectWithinAbsoluteError(maxError, 0.0f, 0.0f);
+            bus.leave(testGroup, slot);
+        }
+
+        beginTest("The linked level ramps across the block");
+        {
+            // a steady tone under the threshold, then another member's level well above it
+            const auto render = [](int rampSamples)
+            {
+                ParallelCompressorEngine engine;
+                prepareEngine(engine);
+
+                juce::AudioBuffer<float> output(1, 2 * blockSize);
+                output.clear();
+
+                for (int block = 0; block < 2; ++block)
+                {
+                    float* channels[] = { output.getWritePointer(0, block * blockSize) };
+                    juce::FloatVectorOperations::fill(channels[0], 0.01f, blockSize);
+
+                    engine.setLinkedLevel(block == 0 ? 0.0f : 1.0f, rampSamples);
+
+                    // in two calls, as a host splitting its block would
+                    engine.process(channels, 1, blockSize / 3);
+                    channels[0] += blockSize / 3;
+                    engine.process(channels, 1, blockSize - blockSize / 3);
+                }
+
+                return output;
+            };
+
+            const auto stepped = render(0);
+            const auto ramped = render(blockSize);
+            const auto maxStep = [](const juce::AudioBuffer<float>& output)
+            {
+                auto step = 0.0f;
+
+                for (int i = 1; i < output.getNumSamples(); ++i)
+                    step = juce::jmax(step, std::abs(output.getSample(0, i) - output.getSample(0, i - 1)));
+
+                return step;
+            };
+
+            // both land on the same gain by the end of the block, but only the stepped one jumps
+            expectWithinAbsoluteError(ramped.getSample(0, 2 * blockSize - 1), stepped.getSample(0, 2 * blockSize - 1), 1.0e-6f);
+            expectLessThan(maxStep(ramped), 0.5f * maxStep(stepped));
+        }
+    }
+
+private:
+    static constexpr int testGroup = LinkBus::numGroups;
+    static constexpr int otherGroup = LinkBus::numGroups - 1;
+    static constexpr int blockSize = 256;
+
+    static void prepareEngine(ParallelCompressorEngine& engine)
+    {
+        EngineParameters parameters;
+        parameters.threshold = -30.0f;
+        parameters.ratio = 4.0f;
+        parameters.attack = 1.0f;
+        parameters.release = 3.0f;
+        parameters.mixer = 100.0f;
+
+        engine.setParameters(parameters);
+        engine.prepare(48000.0, blockSize, 2);
+    }
+};
+
+static LinkBusTest linkBusTest;
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Runs the unit tests. Pass a category (e.g. "Processor") to run only that
+    category; exits non-zero if anything failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // the processor's treestate and wave viewer expect a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if (argc > 1)
+        runner.runTestsInCategory(argv[1]);
+    else
+        runner.runAllTests();
+
+    auto failures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    OfflineRendererTest.cpp
+
+    Segmented renders of a file against the serial render of it: each
+    segment's warm-up and replayed automation have to bring it within the
+    tolerance by the time its output starts, also for hot float files.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+class OfflineRendererTest : public juce::UnitTest
+{
+public:
+    OfflineRendererTest() : juce::UnitTest("Offline renderer", "Renderer") {}
+
+    void runTest() override
+    {
+        beginTest("Segments match the serial render under ramping automation");
+        {
+            // ramps long enough for the gain and mix ramps to trail them across every segment start
+            AutomationLanes lanes;
+            expect(lanes.parse(R"({
+                                      "input gain": [ [0.0, 0.0], [2.0, 6.0], [6.0, -6.0] ],
+                                      "mixer":      [ [0.0, 100.0], [1.0, 100.0], [7.0, 20.0] ],
+                                      "side mixer": [ [0.0, 100.0], [8.0, 0.0] ],
+                                      "threshold":  [ [3.0, -24.0], [3.0, -18.0] ]
+                                  })").wasOk());
+
+            for (auto stereoMode : { StereoMode::leftRight, StereoMode::midSide })
+            {
+                auto parameters = getParameters();
+                parameters.stereoMode = stereoMode;
+
+                expectMatchesSerial(createSignal(2, 8.0, 0.5f), parameters, &lanes);
+            }
+        }
+
+        beginTest("Segments match the serial render of a float file over 0 dBFS");
+        {
+            // peaking at +18 dBFS, with the input gain and output gain adding to it
+            auto parameters = getParameters();
+            parameters.inputGain = 6.0f;
+            parameters.outputGain = 6.0f;
+
+            expectMatchesSerial(createSignal(2, 4.0, juce::Decibels::decibelsToGain(18.0f)), parameters, nullptr);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 16000.0;
+    static constexpr int numSegments = 4;
+    static constexpr float toleranceDb = -120.0f;
+
+    static EngineParameters getParameters()
+    {
+        EngineParameters parameters;
+        parameters.threshold = -24.0f;
+        parameters.ratio = 4.0f;
+        parameters.attack = 1.0f;
+        parameters.release = 3.0f;
+        parameters.mixer = 70.0f;
+        return parameters;
+    }
+
+    // noise alternating between peak and 20 dB below it every 100ms, so the envelopes keep moving
+    static juce::AudioBuffer<float> createSignal(int numChannels, double seconds, float peak)
+    {
+        juce::AudioBuffer<float> signal(numChannels, static_cast<int>(seconds * sampleRate));
+        juce::Random random(1);
+
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+        {
+            const auto level = (i / static_cast<int>(sampleRate / 10.0)) % 2 == 0 ? peak : 0.1f * peak;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                signal.setSample(ch, i, level * (2.0f * random.nextFloat() - 1.0f));
+        }
+
+        return signal;
+    }
+
+    void expectMatchesSerial(const juce::AudioBuffer<float>& signal, const EngineParameters& parameters,
+                             const AutomationLanes* automation)
+    {
+        juce::TemporaryFile input(".wav"), output(".wav");
+        expect(writeWav(input.getFile(), signal), "couldn't write " + input.getFile().getFullPathName());
+
+        OfflineRenderer::Options options;
+        options.numSegments = numSegments;
+        options.toleranceDb = toleranceDb;
+        options.verifyAgainstSerial = true;
+        options.automation = automation;
+
+        OfflineRenderer::Report report;
+        const auto result = OfflineRenderer::render(input.getFile(), output.getFile(), parameters, options, &report);
+        expect(result.wasOk(), result.getErrorMessage());
+
+        logMessage(juce::String(report.numSegments) + " segments, " + juce::String(report.warmUpSamples) + "-sample warm-up: "
+                   + juce::String(report.maxErrorDb, 1) + " dBFS from the serial render");
+
+        expectEquals(report.numSegments, numSegments);
+        expect(report.verified);
+        expectLessOrEqual(report.maxErrorDb, static_cast<double>(toleranceDb));
+    }
+
+    static bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& buffer)
+    {
+        juce::WavAudioFormat wav;
+        auto stream = file.createOutputStream();
+
+        if (stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(buffer.getNumChannels()),
+                                                                            32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release(); // now owned by the writer
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+};
+
+static OfflineRendererTest offlineRendererTest;
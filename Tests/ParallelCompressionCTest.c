@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    ParallelCompressionCTest.c
+
+    Drives the C API from plain C the way a render server would: a pool of
+    engines prepared up front, parameters looked up by ID, many streams
+    processed per call with pc_process_batch, interleaved I/O, state saved
+    from one engine and restored into another, and the error returns.
+    Exits non-zero if any check fails.
+
+  ==============================================================================
+*/
+
+#include "ParallelCompressionC.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SAMPLE_RATE   48000.0
+#define BLOCK_SIZE    256
+#define NUM_ENGINES   64
+#define NUM_BLOCKS    400
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { if (! (condition)) { fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); ++failures; } } while (0)
+
+//==============================================================================
+static int find_parameter (const char* id)
+{
+    int i;
+
+    for (i = 0; i < pc_get_num_parameters(); ++i)
+        if (strcmp (pc_get_parameter_id (i), id) == 0)
+            return i;
+
+    return -1;
+}
+
+// noise bursts alternating between 0 and -30 dBFS every 50ms
+static void fill_signal (float* dest, int num_samples, long start, unsigned* seed)
+{
+    int i;
+
+    for (i = 0; i < num_samples; ++i)
+    {
+        const float level = ((start + i) / 2400) % 2 == 0 ? 1.0f : 0.0316f;
+        *seed = *seed * 1664525u + 1013904223u;
+        dest[i] = level * ((float) (*seed >> 8) / 8388608.0f - 1.0f);
+    }
+}
+
+static int all_finite (const float* samples, int num_samples)
+{
+    int i;
+
+    for (i = 0; i < num_samples; ++i)
+        if (! isfinite (samples[i]))
+            return 0;
+
+    return 1;
+}
+
+//==============================================================================
+static void test_errors (void)
+{
+    float buffer[BLOCK_SIZE] = { 0 };
+    float* channels[1] = { buffer };
+    pc_engine* engine = pc_create();
+
+    CHECK (engine != NULL);
+    CHECK (pc_process_planar (engine, channels, 1, BLOCK_SIZE) == PC_ERROR_NOT_PREPARED);
+    CHECK (pc_prepare (engine, SAMPLE_RATE, BLOCK_SIZE, 3) == PC_ERROR_INVALID_ARGUMENT);
+    CHECK (pc_prepare (engine, 0.0, BLOCK_SIZE, 1) == PC_ERROR_INVALID_ARGUMENT);
+    CHECK (pc_prepare (engine, SAMPLE_RATE, BLOCK_SIZE, 1) == PC_OK);
+    CHECK (pc_process_planar (engine, channels, 0, BLOCK_SIZE) == PC_ERROR_INVALID_ARGUMENT);
+    CHECK (pc_process_planar (engine, channels, 1, 0) == PC_OK);
+    CHECK (pc_set_parameter (engine, -1, 0.0f) == PC_ERROR_INVALID_ARGUMENT);
+    CHECK (pc_set_parameter (engine, pc_get_num_parameters(), 0.0f) == PC_ERROR_INVALID_ARGUMENT);
+    CHECK (pc_get_parameter_id (pc_get_num_parameters()) == NULL);
+    CHECK (pc_set_state (engine, buffer, 4) == PC_ERROR_INVALID_ARGUMENT);
+
+    pc_destroy (engine);
+}
+
+// a server's pool: every engine with its own settings and layout, all processed in one call per block
+static void test_batch (void)
+{
+    pc_engine* engines[NUM_ENGINES];
+    float* channel_data[NUM_ENGINES][2];
+    pc_stream streams[NUM_ENGINES];
+    const int threshold = find_parameter ("threshold");
+    const int ratio = find_parameter ("ratio");
+    const int mixer = find_parameter ("mixer");
+    const int stereo_mode = find_parameter ("stereo mode");
+    const int auto_release = find_parameter ("auto release");
+    unsigned seed = 1;
+    clock_t start;
+    double seconds;
+    int e, ch, block;
+
+    CHECK (threshold >= 0 && ratio >= 0 && mixer >= 0 && stereo_mode >= 0 && auto_release >= 0);
+    CHECK (find_parameter ("quality") < 0 && find_parameter ("link group") < 0);
+
+    for (e = 0; e < NUM_ENGINES; ++e)
+    {
+        const int num_channels = e % 4 == 0 ? 1 : 2;
+
+        engines[e] = pc_create();
+        CHECK (engines[e] != NULL);
+        CHECK (pc_set_parameter (engines[e], threshold, -36.0f + (float) (e % 12) * 3.0f) == PC_OK);
+        CHECK (pc_set_parameter (engines[e], ratio, 2.0f + (float) (e % 5)) == PC_OK);
+        CHECK (pc_set_parameter (engines[e], mixer, 50.0f) == PC_OK);
+        CHECK (pc_set_parameter (engines[e], stereo_mode, (float) (e % 4)) == PC_OK);
+        CHECK (pc_set_parameter (engines[e], auto_release, (float) (e % 2)) == PC_OK);
+        CHECK (pc_prepare (engines[e], SAMPLE_RATE, BLOCK_SIZE, num_channels) == PC_OK);
+
+        for (ch = 0; ch < 2; ++ch)
+            channel_data[e][ch] = (float*) malloc (BLOCK_SIZE * sizeof (float));
+
+        streams[e].engine = engines[e];
+        streams[e].channels = channel_data[e];
+        streams[e].num_channels = num_channels;
+        streams[e].num_samples = BLOCK_SIZE;
+    }
+
+    start = clock();
+
+    for (block = 0; block < NUM_BLOCKS; ++block)
+    {
+        for (e = 0; e < NUM_ENGINES; ++e)
+            for (ch = 0; ch < streams[e].num_channels; ++ch)
+                fill_signal (channel_data[e][ch], BLOCK_SIZE, (long) block * BLOCK_SIZE, &seed);
+
+        CHECK (pc_process_batch (streams, NUM_ENGINES) == PC_OK);
+
+        for (e = 0; e < NUM_ENGINES; ++e)
+            for (ch = 0; ch < streams[e].num_channels; ++ch)
+                CHECK (all_finite (channel_data[e][ch], BLOCK_SIZE));
+    }
+
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    printf ("batch: %d engines x %d blocks of %d samples in %.3f s (%.0f real-time streams)\n",
+            NUM_ENGINES, NUM_BLOCKS, BLOCK_SIZE, seconds,
+            seconds > 0.0 ? NUM_ENGINES * (NUM_BLOCKS * BLOCK_SIZE / SAMPLE_RATE) / seconds : 0.0);
+
+    for (e = 0; e < NUM_ENGINES; ++e)
+    {
+        for (ch = 0; ch < 2; ++ch)
+            free (channel_data[e][ch]);
+
+        pc_destroy (engines[e]);
+    }
+}
+
+// interleaved I/O must match planar, including across chunks larger than the prepared block size
+static void test_interleaved (void)
+{
+    enum { num_frames = BLOCK_SIZE * 5 + 17 };
+    static float left[num_frames], right[num_frames], interleaved[num_frames * 2];
+    float* channels[2] = { left, right };
+    pc_engine* planar_engine = pc_create();
+    pc_engine* interleaved_engine = pc_create();
+    unsigned seed = 2;
+    int i;
+
+    fill_signal (left, num_frames, 0, &seed);
+    fill_signal (right, num_frames, 0, &seed);
+
+    for (i = 0; i < num_frames; ++i)
+    {
+        interleaved[2 * i] = left[i];
+        interleaved[2 * i + 1] = right[i];
+    }
+
+    CHECK (pc_set_parameter (planar_engine, find_parameter ("threshold"), -24.0f) == PC_OK);
+    CHECK (pc_set_parameter (interleaved_engine, find_parameter ("threshold"), -24.0f) == PC_OK);
+    CHECK (pc_prepare (planar_engine, SAMPLE_RATE, BLOCK_SIZE, 2) == PC_OK);
+    CHECK (pc_prepare (interleaved_engine, SAMPLE_RATE, BLOCK_SIZE, 2) == PC_OK);
+
+    CHECK (pc_process_planar (planar_engine, channels, 2, num_frames) == PC_OK);
+    CHECK (pc_process_interleaved (interleaved_engine, interleaved, 2, num_frames) == PC_OK);
+
+    for (i = 0; i < num_frames; ++i)
+    {
+        if (interleaved[2 * i] != left[i] || interleaved[2 * i + 1] != right[i])
+        {
+            CHECK (! "interleaved output differs from planar");
+            break;
+        }
+    }
+
+    pc_destroy (planar_engine);
+    pc_destroy (interleaved_engine);
+}
+
+// a job's settings saved from one engine and restored into a pooled one
+static void test_state (void)
+{
+    pc_engine* source = pc_create();
+    pc_engine* dest = pc_create();
+    const int size = pc_get_state_size();
+    void* state = malloc ((size_t) size);
+    int i;
+
+    for (i = 0; i < pc_get_num_parameters(); ++i)
+        CHECK (pc_set_parameter (source, i, pc_get_parameter (source, i) + 1.0f) == PC_OK);
+
+    CHECK (pc_get_state (source, state, size - 1) == PC_ERROR_INVALID_ARGUMENT);
+    CHECK (pc_get_state (source, state, size) == size);
+    CHECK (pc_set_state (dest, state, size) == PC_OK);
+
+    for (i = 0; i < pc_get_num_parameters(); ++i)
+        CHECK (pc_get_parameter (dest, i) == pc_get_parameter (source, i));
+
+    free (state);
+    pc_destroy (source);
+    pc_destroy (dest);
+}
+
+//==============================================================================
+int main (void)
+{
+    CHECK (pc_get_api_version() == PC_API_VERSION);
+
+    test_errors();
+    test_batch();
+    test_interleaved();
+    test_state();
+
+    printf (failures == 0 ? "all checks passed\n" : "%d checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    RenderDaemonTest.cpp
+
+    Runs the render daemon on a temporary socket and talks to it the way a
+    client would: a render, a stats request, malformed requests, and a client
+    that connects and never sends anything.
+
+  ==============================================================================
+*/
+
+#include "RenderDaemon.h"
+
+#if ! JUCE_WINDOWS
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+//==============================================================================
+class RenderDaemonTest : public juce::UnitTest
+{
+public:
+    RenderDaemonTest() : juce::UnitTest("Render daemon", "Renderer") {}
+
+    void runTest() override
+    {
+       #if ! JUCE_WINDOWS
+        const auto tempDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory);
+        const auto socketFile = tempDirectory.getNonexistentChildFile("pc-daemon", ".sock");
+        juce::TemporaryFile input(".wav"), output(".wav");
+
+        RenderDaemon::Options options;
+        options.socketPath = socketFile.getFullPathName();
+        options.numWorkers = 2;
+        options.requestTimeoutSeconds = requestTimeoutSeconds;
+        options.warmSampleRates = { sampleRate };
+
+        RenderDaemon daemon(options);
+
+        beginTest("Start");
+        {
+            const auto result = daemon.start();
+            expect(result.wasOk(), result.getErrorMessage());
+            expect(socketFile.exists());
+        }
+
+        beginTest("Render");
+        {
+            expect(writeWav(input.getFile()), "couldn't write " + input.getFile().getFullPathName());
+
+            const auto reply = RenderDaemon::sendRequest(options.socketPath, "render\t" + input.getFile().getFullPathName() + "\t"
+                                                                             + output.getFile().getFullPathName() + "\tthreshold=-24\tmixer=50");
+            expect(reply.startsWith("ok "), reply);
+            expect(output.getFile().getSize() > 0, "no output written");
+
+            const auto missing = RenderDaemon::sendRequest(options.socketPath, "render\t" + tempDirectory.getNonexistentChildFile("pc-missing", ".wav").getFullPathName()
+                                                                               + "\t" + output.getFile().getFullPathName());
+            expect(missing.startsWith("error Couldn't open"), missing);
+        }
+
+        beginTest("Stats");
+        {
+            // the render and the missing file have finished (their workers may not have counted themselves out yet)
+            const auto reply = RenderDaemon::sendRequest(options.socketPath, "stats");
+            expect(reply.startsWith("queued 0 running "), reply);
+            expect(reply.contains(" completed 1 failed 1 p50 "), reply);
+        }
+
+        beginTest("Malformed requests");
+        {
+            expectEquals(RenderDaemon::sendRequest(options.socketPath, "bogus"), juce::String("error bad request"));
+            expectEquals(RenderDaemon::sendRequest(options.socketPath, "render\tonly-input.wav"), juce::String("error bad request"));
+            expectEquals(RenderDaemon::sendRequest(options.socketPath, "render\tin.wav\tout.wav\tthresh=-24"),
+                         juce::String("error unknown parameter thresh"));
+        }
+
+        beginTest("A silent client times out");
+        {
+            const auto connection = connectTo(options.socketPath);
+            expect(connection >= 0, "couldn't connect");
+
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            const auto reply = readReply(connection);
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+            ::close(connection);
+
+            expectEquals(reply, juce::String("error bad request"));
+            expectGreaterOrEqual(seconds, requestTimeoutSeconds - 0.1);
+            expectLessThan(seconds, requestTimeoutSeconds + 5.0);
+
+            // and the worker it held is free again
+            expect(RenderDaemon::sendRequest(options.socketPath, "stats").startsWith("queued 0 "));
+        }
+
+        beginTest("Stop");
+        {
+            daemon.stop();
+            expect(! socketFile.exists());
+            expect(RenderDaemon::sendRequest(options.socketPath, "stats").startsWith("error couldn't connect"));
+        }
+       #endif
+    }
+
+private:
+    static constexpr double sampleRate = 16000.0;
+    static constexpr int requestTimeoutSeconds = 1;
+
+    // half a second of stereo noise
+    static bool writeWav(const juce::File& file)
+    {
+        juce::AudioBuffer<float> buffer(2, static_cast<int>(sampleRate / 2.0));
+        juce::Random random(1);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, 0.5f * (2.0f * random.nextFloat() - 1.0f));
+
+        juce::WavAudioFormat wav;
+        auto stream = file.createOutputStream();
+
+        if (stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, 2, 32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release(); // now owned by the writer
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+
+   #if ! JUCE_WINDOWS
+    static int connectTo(const juce::String& socketPath)
+    {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        socketPath.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+        const auto connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (connection >= 0 && ::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            ::close(connection);
+            return -1;
+        }
+
+        return connection;
+    }
+
+    static juce::String readReply(int connection)
+    {
+        juce::MemoryOutputStream line;
+        char c = 0;
+
+        while (::read(connection, &c, 1) == 1 && c != '\n')
+            line.writeByte(c);
+
+        return line.toUTF8();
+    }
+   #endif
+};
+
+static RenderDaemonTest renderDaemonTest;